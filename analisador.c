@@ -0,0 +1,389 @@
+// Analisador do rastro binario gravado por trabalho -r (formato em rastro.h).
+// Le o arquivo uma vez so, do inicio ao fim, guardando apenas os voos em andamento:
+//  - linha do tempo de cada voo (-l arquivo.csv), escrita quando o voo termina; na rede (-n), uma
+//    linha por trecho, escrita quando o voo chega ao aeroporto seguinte ou termina;
+//  - profundidade das filas de Pista, Portao e Torre de cada aeroporto ao longo do tempo (media e
+//    maximo por janela);
+//  - distribuicao da espera de cada fase, por tipo de voo.
+// Compilar: gcc -O2 -Wall analisador.c -o analisador
+// Uso: ./analisador [-l linhas.csv] [-j segundos] rastro.bin   ("-" le da entrada padrao)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include "rastro.h"
+
+#define NS_POR_SEGUNDO 1000000000LL
+#define NS_POR_MILISSEGUNDO 1000000LL
+#define REGISTROS_POR_LEITURA 4096
+#define BALDES_ESPERA 2048   // Baldes de 100 ms; o ultimo junta o resto
+#define NS_POR_BALDE_ESPERA (100 * NS_POR_MILISSEGUNDO)
+
+// Linha do tempo de um trecho em andamento: o voo codigo no aeroporto, no seu trecho-esimo pouso.
+// O rastro nao grava o trecho: ele conta as chegadas do voo, e o trecho anterior termina quando o
+// voo que decolou dele chega a outro aeroporto. Instantes em ns; -1 enquanto nao aconteceu.
+typedef struct {
+    int32_t codigo;
+    int aeroporto, trecho;
+    int ocupado, decolou;
+    uint8_t tipo;
+    int criticoNaChegada, mayday;
+    int64_t chegada;
+    int64_t pedido[NUM_FASES], inicio[NUM_FASES], fim[NUM_FASES];
+} LinhaDoTempo;
+
+// Tabela hash (sondagem linear) dos trechos em andamento, indexada por aeroporto e codigo do voo.
+// Cada voo tem no maximo um trecho em andamento em cada aeroporto.
+typedef struct {
+    LinhaDoTempo *posicoes;
+    size_t capacidade, ocupadas;
+} TabelaDeVoos;
+
+typedef struct {
+    long quantidade;
+    int64_t soma, maximo;
+    long baldes[BALDES_ESPERA];
+} Distribuicao;
+
+// Profundidade das filas de cada aeroporto: valor atual e, na janela corrente, a integral no tempo e o maximo
+typedef struct {
+    int64_t janelaNs, fimDaJanela, ultimoInstante;
+    int profundidade[RASTRO_MAX_AEROPORTOS][NUM_RECURSOS];
+    int maximoNaJanela[RASTRO_MAX_AEROPORTOS][NUM_RECURSOS], maximoGeral[RASTRO_MAX_AEROPORTOS][NUM_RECURSOS];
+    double integralNaJanela[RASTRO_MAX_AEROPORTOS][NUM_RECURSOS], integralGeral[RASTRO_MAX_AEROPORTOS][NUM_RECURSOS];
+    int iniciado;
+    int cabecalhoEmRede; // -1 antes de imprimir o cabecalho; 1 se ele tem a coluna do aeroporto
+} CurvaDasFilas;
+
+typedef enum { FIM_CONCLUIDO, FIM_ACIDENTE, FIM_TRECHO } FimDoTrecho;
+static const char *const nomesDosFins[] = { "CONCLUIDO", "ACIDENTE", "TRECHO" };
+
+static TabelaDeVoos voos;
+static Distribuicao esperas[NUM_FASES][2];
+static CurvaDasFilas filas = { .cabecalhoEmRede = -1 };
+static FILE *linhas;
+static long voosConcluidos, voosAcidentados, trechosVoados, registrosLidos;
+static int numeroDeAeroportos = 1; // Maior aeroporto visto no rastro mais um
+
+static int indiceDaFase(int fase) {
+    return fase == POUSANDO ? 0 : (fase == DESEMBARCANDO ? 1 : (fase == DECOLANDO ? 2 : -1));
+}
+
+static size_t espalhar(int aeroporto, int32_t codigo) {
+    return ((uint32_t)codigo * 2654435761u) ^ ((uint32_t)aeroporto * 40503u);
+}
+
+static void crescerTabela();
+
+static LinhaDoTempo* buscarVoo(int aeroporto, int32_t codigo, int criar) {
+    if (criar && (voos.ocupadas + 1) * 2 > voos.capacidade) crescerTabela();
+    size_t mascara = voos.capacidade - 1;
+    for (size_t i = espalhar(aeroporto, codigo) & mascara;; i = (i + 1) & mascara) {
+        LinhaDoTempo *voo = &voos.posicoes[i];
+        if (voo->ocupado && voo->codigo == codigo && voo->aeroporto == aeroporto) return voo;
+        if (!voo->ocupado) {
+            if (!criar) return NULL;
+            memset(voo, 0, sizeof(*voo));
+            voo->ocupado = 1;
+            voo->codigo = codigo;
+            voo->aeroporto = aeroporto;
+            voo->trecho = 1;
+            voo->chegada = -1;
+            for (int f = 0; f < NUM_FASES; f++) voo->pedido[f] = voo->inicio[f] = voo->fim[f] = -1;
+            voos.ocupadas++;
+            return voo;
+        }
+    }
+}
+
+static void crescerTabela() {
+    TabelaDeVoos antiga = voos;
+    voos.capacidade = antiga.capacidade ? antiga.capacidade * 2 : 1024;
+    voos.posicoes = calloc(voos.capacidade, sizeof(LinhaDoTempo));
+    if (voos.posicoes == NULL) { perror("calloc"); exit(1); }
+    voos.ocupadas = 0;
+    for (size_t i = 0; i < antiga.capacidade; i++) {
+        if (antiga.posicoes[i].ocupado) {
+            *buscarVoo(antiga.posicoes[i].aeroporto, antiga.posicoes[i].codigo, 1) = antiga.posicoes[i];
+        }
+    }
+    free(antiga.posicoes);
+}
+
+// Remocao com deslocamento para tras: a sondagem linear continua sem lapides
+static void removerVoo(LinhaDoTempo *voo) {
+    size_t mascara = voos.capacidade - 1;
+    size_t vazio = voo - voos.posicoes;
+    voos.posicoes[vazio].ocupado = 0;
+    voos.ocupadas--;
+    for (size_t i = (vazio + 1) & mascara; voos.posicoes[i].ocupado; i = (i + 1) & mascara) {
+        size_t ideal = espalhar(voos.posicoes[i].aeroporto, voos.posicoes[i].codigo) & mascara;
+        // Move se a posicao ideal nao fica entre o buraco e i (andando em circulo)
+        if (((i - ideal) & mascara) >= ((i - vazio) & mascara)) {
+            voos.posicoes[vazio] = voos.posicoes[i];
+            voos.posicoes[i].ocupado = 0;
+            vazio = i;
+        }
+    }
+}
+
+static void imprimirInstante(int64_t instante) {
+    if (instante >= 0) fprintf(linhas, ",%.3f", (double)instante / NS_POR_SEGUNDO);
+    else fputs(",", linhas);
+}
+
+static void terminarVoo(LinhaDoTempo *voo, FimDoTrecho fim) {
+    if (fim == FIM_ACIDENTE) voosAcidentados++;
+    else if (fim == FIM_CONCLUIDO) voosConcluidos++;
+    else trechosVoados++;
+    if (linhas != NULL) {
+        fprintf(linhas, "%d,%d,%d,%s,%d", voo->codigo, voo->aeroporto, voo->trecho,
+                voo->tipo == INTERNACIONAL ? "I" : "D", voo->criticoNaChegada);
+        imprimirInstante(voo->chegada);
+        for (int f = 0; f < NUM_FASES; f++) {
+            imprimirInstante(voo->pedido[f]);
+            imprimirInstante(voo->inicio[f]);
+            imprimirInstante(voo->fim[f]);
+        }
+        fprintf(linhas, ",%d,%s\n", voo->mayday, nomesDosFins[fim]);
+    }
+    removerVoo(voo);
+}
+
+// Chegada do voo codigo ao aeroporto. Se ele decolou de outro aeroporto, aquele trecho acabou e este e o seguinte.
+static LinhaDoTempo* comecarTrecho(int aeroporto, int32_t codigo) {
+    int trecho = 1;
+    for (int a = 0; a < numeroDeAeroportos; a++) {
+        LinhaDoTempo *anterior = a != aeroporto ? buscarVoo(a, codigo, 0) : NULL;
+        if (anterior != NULL && anterior->decolou) {
+            trecho = anterior->trecho + 1;
+            terminarVoo(anterior, FIM_TRECHO);
+            break;
+        }
+    }
+    LinhaDoTempo *voo = buscarVoo(aeroporto, codigo, 1);
+    voo->trecho = trecho;
+    return voo;
+}
+
+static void registrarEspera(Distribuicao *d, int64_t espera) {
+    int64_t balde = espera / NS_POR_BALDE_ESPERA;
+    d->quantidade++;
+    d->soma += espera;
+    if (espera > d->maximo) d->maximo = espera;
+    d->baldes[balde < BALDES_ESPERA ? balde : BALDES_ESPERA - 1]++;
+}
+
+// Na rede cada linha da curva e de um aeroporto. O cabecalho sai de novo se o rastro so mostra mais tarde que e de uma rede.
+static void imprimirCabecalhoDaCurva() {
+    filas.cabecalhoEmRede = numeroDeAeroportos > 1;
+    printf("%9s", "Ate (s)");
+    if (filas.cabecalhoEmRede) printf(" %4s", "Aero");
+    for (int r = 0; r < NUM_RECURSOS; r++) printf(" %8s %5s", nomesDosRecursos[r], "max");
+    printf("\n");
+}
+
+// Fecha as janelas que terminam antes de instante, acumulando a profundidade atual ate la
+static void avancarCurva(int64_t instante) {
+    if (!filas.iniciado) {
+        filas.iniciado = 1;
+        filas.ultimoInstante = 0;
+        filas.fimDaJanela = filas.janelaNs;
+    }
+    // Em tempo real os workers gravam quase em ordem; um instante atrasado conta como o ultimo
+    if (instante < filas.ultimoInstante) instante = filas.ultimoInstante;
+    while (instante >= filas.fimDaJanela) {
+        if (filas.cabecalhoEmRede != (numeroDeAeroportos > 1)) imprimirCabecalhoDaCurva();
+        for (int a = 0; a < numeroDeAeroportos; a++) {
+            printf("%9.0f", (double)filas.fimDaJanela / NS_POR_SEGUNDO);
+            if (filas.cabecalhoEmRede) printf("  A%02d", a);
+            for (int r = 0; r < NUM_RECURSOS; r++) {
+                double trecho = (double)filas.profundidade[a][r] * (filas.fimDaJanela - filas.ultimoInstante);
+                filas.integralNaJanela[a][r] += trecho;
+                filas.integralGeral[a][r] += trecho;
+                printf(" %8.2f %5d", filas.integralNaJanela[a][r] / filas.janelaNs, filas.maximoNaJanela[a][r]);
+                filas.integralNaJanela[a][r] = 0;
+                filas.maximoNaJanela[a][r] = filas.profundidade[a][r];
+            }
+            printf("\n");
+        }
+        filas.ultimoInstante = filas.fimDaJanela;
+        filas.fimDaJanela += filas.janelaNs;
+    }
+    for (int a = 0; a < numeroDeAeroportos; a++) {
+        for (int r = 0; r < NUM_RECURSOS; r++) {
+            double trecho = (double)filas.profundidade[a][r] * (instante - filas.ultimoInstante);
+            filas.integralNaJanela[a][r] += trecho;
+            filas.integralGeral[a][r] += trecho;
+        }
+    }
+    filas.ultimoInstante = instante;
+}
+
+static void mudarFila(int aeroporto, int recurso, int delta) {
+    if (recurso < 0 || recurso >= NUM_RECURSOS) return;
+    int *p = &filas.profundidade[aeroporto][recurso];
+    *p += delta;
+    if (*p < 0) *p = 0; // So com rastro cortado no meio
+    if (*p > filas.maximoNaJanela[aeroporto][recurso]) filas.maximoNaJanela[aeroporto][recurso] = *p;
+    if (*p > filas.maximoGeral[aeroporto][recurso]) filas.maximoGeral[aeroporto][recurso] = *p;
+}
+
+static void processarRegistro(const RegistroLog *registro) {
+    registrosLidos++;
+    avancarCurva(registro->instante);
+    if (registro->voo < 0) return; // Aviso da simulacao
+    int aeroporto = RASTRO_AEROPORTO(registro->tipo);
+    if (aeroporto >= numeroDeAeroportos) numeroDeAeroportos = aeroporto + 1;
+    int fase = indiceDaFase(registro->fase);
+    LinhaDoTempo *voo = buscarVoo(aeroporto, registro->voo, 0);
+    if (voo == NULL) {
+        voo = registro->mensagem == MSG_CHEGADA ? comecarTrecho(aeroporto, registro->voo)
+                                                : buscarVoo(aeroporto, registro->voo, 1);
+    }
+    voo->tipo = registro->tipo & 1;
+    switch (registro->mensagem) {
+        case MSG_CHEGADA:
+            voo->chegada = registro->instante;
+            voo->criticoNaChegada = (registro->tipo & RASTRO_CRITICO) != 0;
+            break;
+        case MSG_PEDIDO_DA_FASE:
+            if (fase >= 0) voo->pedido[fase] = registro->instante;
+            break;
+        case MSG_INICIO_DA_FASE:
+            if (fase < 0) break;
+            voo->inicio[fase] = registro->instante;
+            if (voo->pedido[fase] >= 0) registrarEspera(&esperas[fase][voo->tipo], registro->instante - voo->pedido[fase]);
+            break;
+        case MSG_FIM_DA_FASE:
+            if (fase >= 0) voo->fim[fase] = registro->instante;
+            if (registro->fase == DECOLANDO) voo->decolou = 1;
+            break;
+        case MSG_MAYDAY:
+            voo->mayday = 1;
+            break;
+        case MSG_ENTROU_NA_FILA:
+            mudarFila(aeroporto, registro->recurso, +1);
+            break;
+        case MSG_SAIU_DA_FILA:
+            mudarFila(aeroporto, registro->recurso, -1);
+            break;
+        case MSG_CONCLUIDO:
+            terminarVoo(voo, FIM_CONCLUIDO);
+            break;
+        case MSG_QUEDA:
+            terminarVoo(voo, FIM_ACIDENTE);
+            break;
+        default:
+            break;
+    }
+}
+
+// Limite superior do balde onde cai o percentil p (0 a 1)
+static double percentil(const Distribuicao *d, double p) {
+    long alvo = (long)(p * d->quantidade), acumulado = 0;
+    for (int i = 0; i < BALDES_ESPERA; i++) {
+        acumulado += d->baldes[i];
+        if (acumulado > alvo) return (i + 1) * 0.1;
+    }
+    return BALDES_ESPERA * 0.1;
+}
+
+static void imprimirEsperas() {
+    static const double limites[] = { 1, 5, 15, 30, 60, 90 }; // s
+    const int numLimites = sizeof(limites) / sizeof(limites[0]);
+    printf("\n--- ESPERA PELOS RECURSOS DE CADA FASE (s) ---\n");
+    printf("%-12s %-13s %9s %8s %7s %7s %7s %8s |", "Fase", "Tipo", "Esperas", "Media", "p50", "p90", "p99", "Max.");
+    printf("    <1s   1-5s  5-15s 15-30s 30-60s 60-90s   >90s\n");
+    for (int f = 0; f < NUM_FASES; f++) {
+        for (int t = 0; t < 2; t++) {
+            const Distribuicao *d = &esperas[f][t];
+            if (d->quantidade == 0) continue;
+            printf("%-12s %-13s %9ld %8.2f %7.1f %7.1f %7.1f %8.2f |", nomesDasFases[f],
+                   t == INTERNACIONAL ? "Internacional" : "Domestico", d->quantidade,
+                   (double)d->soma / d->quantidade / NS_POR_SEGUNDO, percentil(d, 0.5), percentil(d, 0.9),
+                   percentil(d, 0.99), (double)d->maximo / NS_POR_SEGUNDO);
+            // Parte das esperas em cada faixa, em %
+            int balde = 0;
+            for (int l = 0; l <= numLimites; l++) {
+                int ate = l < numLimites ? (int)(limites[l] * NS_POR_SEGUNDO / NS_POR_BALDE_ESPERA) : BALDES_ESPERA;
+                long n = 0;
+                for (; balde < ate; balde++) n += d->baldes[balde];
+                printf(" %5.1f%%", 100.0 * n / d->quantidade);
+            }
+            printf("\n");
+        }
+    }
+}
+
+int main(int argc, char *argv[]) {
+    int opcao;
+    double janelaSegundos = 60;
+    const char *caminhoDasLinhas = NULL;
+    while ((opcao = getopt(argc, argv, "l:j:")) != -1) {
+        switch (opcao) {
+            case 'l': caminhoDasLinhas = optarg; break;
+            case 'j': janelaSegundos = atof(optarg); break;
+            default:
+            uso:
+                fprintf(stderr, "Uso: %s [-l linhas.csv] [-j segundos] rastro.bin\n", argv[0]);
+                fprintf(stderr, "  -l  grava a linha do tempo de cada voo em CSV\n");
+                fprintf(stderr, "  -j  janela da curva de profundidade das filas (padrao 60 s)\n");
+                return 1;
+        }
+    }
+    if (optind != argc - 1 || janelaSegundos <= 0) goto uso;
+    FILE *entrada = strcmp(argv[optind], "-") == 0 ? stdin : fopen(argv[optind], "rb");
+    if (entrada == NULL) { perror(argv[optind]); return 1; }
+    CabecalhoRastro cabecalho;
+    if (fread(&cabecalho, sizeof(cabecalho), 1, entrada) != 1 || memcmp(cabecalho.assinatura, "RAST", 4) != 0) {
+        fprintf(stderr, "%s: nao e um rastro do simulador\n", argv[optind]);
+        return 1;
+    }
+    if (cabecalho.versao != VERSAO_RASTRO) {
+        fprintf(stderr, "%s: versao %u do rastro nao suportada\n", argv[optind], cabecalho.versao);
+        return 1;
+    }
+    if (caminhoDasLinhas != NULL) {
+        linhas = fopen(caminhoDasLinhas, "w");
+        if (linhas == NULL) { perror(caminhoDasLinhas); return 1; }
+        fprintf(linhas, "voo,aeroporto,trecho,tipo,critico,chegada");
+        for (int f = 0; f < NUM_FASES; f++) fprintf(linhas, ",pedido_%s,inicio_%s,fim_%s", nomesDasFases[f], nomesDasFases[f], nomesDasFases[f]);
+        fprintf(linhas, ",mayday,resultado\n");
+    }
+    filas.janelaNs = (int64_t)(janelaSegundos * NS_POR_SEGUNDO);
+    crescerTabela();
+
+    printf("--- Rastro: %s (%s), Pistas %u, Portoes %u, Torre %u ---\n", argv[optind],
+           cabecalho.modoEventos ? "eventos discretos" : "tempo real",
+           cabecalho.capacidade[PISTA], cabecalho.capacidade[PORTAO], cabecalho.capacidade[TORRE]);
+    printf("\n--- PROFUNDIDADE DAS FILAS (media e maximo a cada %.0f s) ---\n", janelaSegundos);
+
+    static RegistroLog registros[REGISTROS_POR_LEITURA];
+    size_t lidos;
+    while ((lidos = fread(registros, sizeof(RegistroLog), REGISTROS_POR_LEITURA, entrada)) > 0) {
+        for (size_t i = 0; i < lidos; i++) processarRegistro(&registros[i]);
+    }
+    if (entrada != stdin) fclose(entrada);
+    if (linhas != NULL) fclose(linhas);
+    if (filas.cabecalhoEmRede < 0) imprimirCabecalhoDaCurva(); // Rastro mais curto que uma janela
+
+    printf("\n--- RESUMO ---\n");
+    printf("Registros: %ld | Voos concluidos: %ld | Acidentes: %ld | Sem fim no rastro: %zu\n",
+           registrosLidos, voosConcluidos, voosAcidentados, voos.ocupadas);
+    if (numeroDeAeroportos > 1) printf("Aeroportos: %d | Trechos voados entre eles: %ld\n", numeroDeAeroportos, trechosVoados);
+    for (int a = 0; a < numeroDeAeroportos; a++) {
+        if (numeroDeAeroportos > 1) printf("A%02d: ", a);
+        printf("Profundidade media (maxima) das filas:");
+        for (int r = 0; r < NUM_RECURSOS; r++) {
+            printf(" %s %.2f (%d)", nomesDosRecursos[r],
+                   filas.ultimoInstante > 0 ? filas.integralGeral[a][r] / filas.ultimoInstante : 0.0,
+                   filas.maximoGeral[a][r]);
+        }
+        printf("\n");
+    }
+    imprimirEsperas();
+    return 0;
+}
@@ -0,0 +1,112 @@
+// Monitor do retrato publicado por trabalho -m /nome (formato em painel.h).
+// So le a memoria compartilhada: copia o retrato e repete se o seqlock mudou no meio da copia,
+// sem nunca travar nada do simulador. Imprime uma linha por amostra ate a simulacao encerrar.
+// Compilar: gcc -O2 -Wall monitor.c -o monitor   (-lrt em glibc antigas)
+// Uso: ./monitor [-i ms] [-n amostras] /nome
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "painel.h"
+
+#define NS_POR_SEGUNDO 1000000000LL
+#define NS_POR_MILISSEGUNDO 1000000LL
+#define LINHAS_POR_CABECALHO 20
+
+static const char *nomesDasSituacoes[NUM_SITUACOES] = { "Agu", "Pou", "Des", "Dec", "Con", "Aci" };
+
+// Copia consistente do retrato: a sequencia precisa ser par e igual antes e depois da copia
+static void lerRetrato(const PainelCompartilhado *painel, PainelCompartilhado *copia) {
+    for (;;) {
+        unsigned int antes = atomic_load_explicit(&painel->sequencia, memory_order_acquire);
+        if (antes & 1) { sched_yield(); continue; }
+        memcpy(copia, (const void*)painel, sizeof(*copia));
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&painel->sequencia, memory_order_relaxed) == antes) return;
+    }
+}
+
+static void imprimirCabecalho() {
+    printf("%10s", "tempo(s)");
+    for (int i = 0; i < NUM_RECURSOS; i++) printf(" %9s", nomesDosRecursos[i]);
+    printf(" ");
+    for (int i = 0; i < NUM_RECURSOS; i++) {
+        char fila[32];
+        snprintf(fila, sizeof(fila), "f.%s", nomesDosRecursos[i]);
+        printf(" %-8s", fila);
+    }
+    printf(" ");
+    for (int s = 0; s < NUM_SITUACOES; s++) printf(" %6s", nomesDasSituacoes[s]);
+    printf(" %8s %8s %10s\n", "sucesso", "quedas", "espera(s)");
+}
+
+static void imprimirRetrato(const PainelCompartilhado *r) {
+    printf("%10.1f", (double)r->instanteNs / NS_POR_SEGUNDO);
+    for (int i = 0; i < NUM_RECURSOS; i++) printf(" %4d/%-4d", r->disponivel[i], r->capacidade[i]);
+    printf(" ");
+    // Fila por classe: criticos/internacionais/domesticos
+    for (int i = 0; i < NUM_RECURSOS; i++) {
+        char fila[32];
+        snprintf(fila, sizeof(fila), "%d/%d/%d", r->esperando[i][0], r->esperando[i][1], r->esperando[i][2]);
+        printf(" %-8s", fila);
+    }
+    printf(" ");
+    for (int s = 0; s < NUM_SITUACOES; s++) printf(" %6lld", (long long)r->voosPorSituacao[s]);
+    double esperaMedia = r->esperasConcluidas ? (double)r->somaEsperaNs / r->esperasConcluidas / NS_POR_SEGUNDO : 0;
+    printf(" %8lld %8lld %10.2f\n", (long long)r->voosSucesso, (long long)r->voosAcidentados, esperaMedia);
+}
+
+int main(int argc, char *argv[]) {
+    int opcao;
+    long intervaloMs = 1000, amostras = -1;
+    while ((opcao = getopt(argc, argv, "i:n:")) != -1) {
+        switch (opcao) {
+            case 'i': intervaloMs = atol(optarg); break;
+            case 'n': amostras = atol(optarg); break;
+            default:
+            uso:
+                fprintf(stderr, "Uso: %s [-i ms] [-n amostras] /nome\n", argv[0]);
+                fprintf(stderr, "  -i  intervalo entre amostras (padrao 1000 ms)\n");
+                fprintf(stderr, "  -n  para depois de n amostras (padrao: ate a simulacao encerrar)\n");
+                return 1;
+        }
+    }
+    if (optind != argc - 1 || intervaloMs <= 0) goto uso;
+    int fd = shm_open(argv[optind], O_RDONLY, 0);
+    if (fd < 0) { perror(argv[optind]); return 1; }
+    void *mapa = mmap(NULL, sizeof(PainelCompartilhado), PROT_READ, MAP_SHARED, fd, 0);
+    if (mapa == MAP_FAILED) { perror("mmap"); return 1; }
+    close(fd);
+    const PainelCompartilhado *painel = mapa;
+
+    PainelCompartilhado retrato;
+    lerRetrato(painel, &retrato);
+    if (retrato.versao != VERSAO_PAINEL) {
+        fprintf(stderr, "%s: versao %u do painel nao suportada\n", argv[optind], retrato.versao);
+        return 1;
+    }
+    printf("--- Simulador pid %d (%s) ---\n", retrato.pid, retrato.modoEventos ? "eventos discretos" : "tempo real");
+
+    struct timespec pausa = { intervaloMs / 1000, (intervaloMs % 1000) * NS_POR_MILISSEGUNDO };
+    for (long n = 0; amostras < 0 || n < amostras; n++) {
+        if (n > 0) {
+            nanosleep(&pausa, NULL);
+            lerRetrato(painel, &retrato);
+        }
+        if (n % LINHAS_POR_CABECALHO == 0) imprimirCabecalho();
+        imprimirRetrato(&retrato);
+        fflush(stdout);
+        if (retrato.encerrada) {
+            printf("--- Simulacao encerrada (%lld voos criados, %llu retratos publicados) ---\n",
+                   (long long)retrato.voosCriados, (unsigned long long)retrato.publicacoes);
+            break;
+        }
+    }
+    munmap(mapa, sizeof(PainelCompartilhado));
+    return 0;
+}
@@ -0,0 +1,33 @@
+#ifndef PAINEL_H
+#define PAINEL_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include "rastro.h"
+
+// Retrato da simulacao publicado em memoria compartilhada POSIX (trabalho -m /nome) e lido pelo
+// monitor.c. Protegido por um seqlock: o simulador incrementa sequencia antes (fica impar) e
+// depois (fica par) de escrever; o leitor copia e repete se a sequencia mudou ou estava impar.
+// O leitor nunca trava nada do simulador.
+
+#define VERSAO_PAINEL 1
+#define NUM_SITUACOES (ACIDENTE + 1)
+#define NUM_CLASSES 3   // 0 -> Criticos; 1 -> Internacionais; 2 -> Domesticos
+
+typedef struct {
+    atomic_uint sequencia;
+    uint32_t versao;
+    int32_t pid;                        // Processo do simulador
+    int32_t encerrada;                  // 1 no ultimo retrato, depois do ultimo voo
+    int32_t modoEventos;
+    int32_t capacidade[NUM_RECURSOS];
+    int32_t disponivel[NUM_RECURSOS];
+    int32_t esperando[NUM_RECURSOS][NUM_CLASSES];
+    int64_t instanteNs;                 // Relogio da simulacao
+    int64_t voosPorSituacao[NUM_SITUACOES];
+    int64_t voosCriados, voosSucesso, voosAcidentados, alertasDeStarvation, deadlocksEvitados;
+    int64_t concessoes, despertares, esperasConcluidas, somaEsperaNs;
+    uint64_t publicacoes;
+} PainelCompartilhado;
+
+#endif
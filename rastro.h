@@ -0,0 +1,54 @@
+#ifndef RASTRO_H
+#define RASTRO_H
+
+#include <stdint.h>
+
+// Definicoes comuns ao simulador (trabalho.c) e ao analisador de rastros (analisador.c)
+
+typedef enum { DOMESTICO, INTERNACIONAL } TipoVoo;
+typedef enum { AGUARDANDO, POUSANDO, DESEMBARCANDO, DECOLANDO, CONCLUIDO, ACIDENTE } StatusVoo;
+typedef enum { PISTA, PORTAO, TORRE, NUM_RECURSOS } TipoRecurso;
+static const char *const nomesDosRecursos[NUM_RECURSOS] = { "Pista", "Portao", "Torre" };
+#define NUM_FASES 3   // POUSANDO, DESEMBARCANDO e DECOLANDO, cada uma com o seu conjunto de recursos
+static const char *const nomesDasFases[NUM_FASES] = { "Pouso", "Desembarque", "Decolagem" };
+
+// Eventos do log. Os ate MSG_TEMPO_ESGOTADO tem texto e saem no stdout; os outros so vao para o rastro.
+typedef enum {
+    MSG_INICIO_POUSO, MSG_POUSO_CONCLUIDO, MSG_DESEMBARCANDO, MSG_INICIO_DECOLAGEM,
+    MSG_DECOLAGEM_CONCLUIDA, MSG_MAYDAY, MSG_QUEDA, MSG_TIMEOUT, MSG_TEMPO_ESGOTADO,
+    MSG_CHEGADA,            // O voo chegou e vai pedir os recursos do pouso
+    MSG_PEDIDO_DA_FASE,     // Comecou a pedir os recursos da fase (campo fase)
+    MSG_INICIO_DA_FASE,     // Conseguiu todos os recursos: a espera da fase acabou
+    MSG_FIM_DA_FASE,
+    MSG_ENTROU_NA_FILA,     // Campo recurso: fila em que entrou
+    MSG_SAIU_DA_FILA,       // Recebeu o recurso, mudou de classe, caiu ou desistiu por timeout
+    MSG_CONCESSAO,          // Recebeu uma unidade do recurso
+    MSG_LIBERACAO,          // Devolveu uma unidade do recurso
+    MSG_CONCLUIDO,
+    NUM_MENSAGENS
+} MensagemLog;
+
+// Registro do log e do rastro binario, 16 bytes. No arquivo, little-endian como na memoria.
+typedef struct {
+    int64_t instante;     // ns desde o inicio da simulacao (relogio virtual ou CLOCK_MONOTONIC)
+    int32_t voo;          // Codigo do voo; -1 para avisos da simulacao, que nao sao de um voo
+    uint8_t mensagem;     // MensagemLog
+    uint8_t fase;         // StatusVoo no momento do evento
+    int8_t recurso;       // TipoRecurso, -1 se o evento nao e de um recurso
+    uint8_t tipo;         // Bit 0: TipoVoo; bit 1: voo critico; bits 2-7: aeroporto (rede com -n)
+} RegistroLog;
+
+#define RASTRO_CRITICO 2
+#define RASTRO_AEROPORTO(tipo) ((tipo) >> 2)
+#define RASTRO_MAX_AEROPORTOS 64
+
+// Cabecalho do arquivo de rastro, seguido pelos registros ate o fim do arquivo
+#define VERSAO_RASTRO 1
+typedef struct {
+    char assinatura[4];   // "RAST"
+    uint32_t versao;
+    uint16_t capacidade[NUM_RECURSOS]; // Unidades de Pista, Portao e Torre
+    uint16_t modoEventos;              // 1: relogio virtual; 0: tempo real
+} CabecalhoRastro;
+
+#endif
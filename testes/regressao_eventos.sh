@@ -0,0 +1,56 @@
+#!/bin/sh
+# Regressao: o modo de eventos (-e) tem que dar, voo a voo, o mesmo resultado do modo em tempo real.
+# Roda as chegadas fixas de testes/chegadas.csv nos dois modos, em cada politica, com rastro (-r), e
+# compara as linhas do tempo que o analisador extrai: resultado, MAYDAY, instantes de cada fase e espera
+# total de cada voo. Em tempo real os instantes atrasam alguns ms em relacao ao relogio virtual, dai a
+# tolerancia. Um worker so em tempo real: com mais, eventos do mesmo instante podem trocar de ordem.
+# Uso: testes/regressao_eventos.sh   (leva perto de 1 min e meio: o tempo real roda em tempo real)
+
+set -e
+cd "$(dirname "$0")/.."
+dir=$(mktemp -d)
+trap 'rm -rf "$dir"' EXIT
+gcc -O2 -Wall -pthread trabalho.c -o "$dir/trabalho"
+gcc -O2 -Wall analisador.c -o "$dir/analisador"
+
+falhas=0
+for politica in atomica incremental prazo; do
+    "$dir/trabalho" -e -q -s 1 -p $politica -a testes/chegadas.csv -r "$dir/eventos.bin" > /dev/null
+    "$dir/trabalho" -q -s 1 -w 1 -p $politica -a testes/chegadas.csv -r "$dir/tempo_real.bin" > /dev/null
+    "$dir/analisador" -l "$dir/eventos.csv" "$dir/eventos.bin" > /dev/null
+    "$dir/analisador" -l "$dir/tempo_real.csv" "$dir/tempo_real.bin" > /dev/null
+    # Colunas: voo,aeroporto,trecho,tipo,critico,chegada, pedido/inicio/fim de cada fase, mayday,resultado
+    awk -F, -v politica=$politica -v tolerancia=0.25 '
+        function diferente(a, b) { return (a == "") != (b == "") || (a != "" && (a - b > tolerancia || b - a > tolerancia)) }
+        function espera(campos,    f, total) {
+            total = 0
+            for (f = 0; f < 3; f++) if (campos[8 + 3 * f] != "") total += campos[8 + 3 * f] - campos[7 + 3 * f]
+            return total
+        }
+        FNR == 1 { split($0, colunas, ","); next }
+        NR == FNR { eventos[$1 "," $2 "," $3] = $0; next }
+        {
+            chave = $1 "," $2 "," $3
+            if (!(chave in eventos)) { printf "%s: voo %s so no tempo real\n", politica, $1; erros++; next }
+            split(eventos[chave], e, ",")
+            split($0, t, ",")
+            delete eventos[chave]
+            comparados++
+            if (e[4] != t[4] || e[5] != t[5] || e[16] != t[16] || e[17] != t[17]) {
+                printf "%s: voo %s terminou diferente: eventos %s (mayday %s), tempo real %s (mayday %s)\n", politica, $1, e[17], e[16], t[17], t[16]
+                erros++
+                next
+            }
+            for (c = 6; c <= 15; c++) {
+                if (diferente(e[c], t[c])) { printf "%s: voo %s, %s: eventos %s, tempo real %s\n", politica, $1, colunas[c], e[c], t[c]; erros++ }
+            }
+            if (diferente(espera(e), espera(t))) { printf "%s: voo %s, espera total: eventos %.3f, tempo real %.3f\n", politica, $1, espera(e), espera(t); erros++ }
+        }
+        END {
+            for (chave in eventos) { split(chave, k, ","); printf "%s: voo %s so no modo de eventos\n", politica, k[1]; erros++ }
+            if (comparados == 0) { printf "%s: nenhum voo no rastro\n", politica; erros++ }
+            if (erros) exit 1
+            printf "%s: %d voos iguais nos dois modos\n", politica, comparados
+        }' "$dir/eventos.csv" "$dir/tempo_real.csv" || falhas=$((falhas + 1))
+done
+[ $falhas -eq 0 ]
@@ -4,390 +4,3130 @@
 #include <unistd.h>
 #include <time.h>
 #include <errno.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <sched.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <stddef.h>
+#include "rastro.h"
+#include "painel.h"
 
 #define TEMPO_SIMULACAO_MINUTOS 5 // 5m // 1m
-#define NUMERO_PISTAS 3             
-#define NUMERO_PORTOES 5            
-#define CAPACIDADE_TORRE 2          
-#define MAX_VOOS 200
-#define TIMEOUT_TENTATIVA_SEGUNDOS 1 
+#define NUMERO_PISTAS 3
+#define NUMERO_PORTOES 5
+#define CAPACIDADE_TORRE 2
+#define TIMEOUT_TENTATIVA_SEGUNDOS 1
 #define ALERTA_FOME_SEGUNDOS 60   // 60s // 12s
 #define QUEDA_AVIAO_SEGUNDOS 90   // 90s  // 18s
 #define TEMPO_BASE_OPERACAO 2 // Tempo para cada operação
+#define VANTAGEM_CRITICO_SEGUNDOS 30       // Escalonador (-p prazo): quanto o prazo de um voo critico e antecipado
+#define VANTAGEM_INTERNACIONAL_SEGUNDOS 10 // e o de um internacional, na ordem dos pedidos
+#define TRECHOS_POR_VOO 3          // Na rede (-n): trechos de cada voo antes de concluir
+#define TEMPO_DE_VOO_MINIMO 30     // Na rede: duracao de um trecho em segundos, sorteada entre os dois
+#define TEMPO_DE_VOO_MAXIMO 120
 // MULTIPLICADORES DOS RECURSOS
 // PISTA = 0.5
 // TORRE = 0.1
 // PORTAO = 1
+// Duração de cada fase em segundos inteiros (o sleep() trunca a soma dos multiplicadores)
+#define DURACAO_POUSO ((unsigned int)((TEMPO_BASE_OPERACAO * 0.1) + (TEMPO_BASE_OPERACAO * 0.5)))
+#define DURACAO_DESEMBARQUE ((unsigned int)((TEMPO_BASE_OPERACAO * 1) + (TEMPO_BASE_OPERACAO * 0.1)))
+#define DURACAO_DECOLAGEM ((unsigned int)((TEMPO_BASE_OPERACAO * 1) + (TEMPO_BASE_OPERACAO * 0.1) + (TEMPO_BASE_OPERACAO * 0.5)))
+#define NS_POR_SEGUNDO 1000000000LL
+#define NS_POR_MILISSEGUNDO 1000000LL
+#define CAPACIDADE_LOG 65536 // Registros no buffer circular do log (potencia de 2)
+#define LOTE_LOG 256         // Registros formatados por escrita no stdout
+#define VOOS_POR_BLOCO 1024  // Tamanho do primeiro bloco da tabela de voos; cada bloco seguinte dobra
+#define MAX_BLOCOS_DE_VOOS 32
+#define VOOS_POR_LOTE 1024   // InfoVoo alocados de uma vez quando a reserva de voos fica vazia
+#define JANELA_DE_LEITURA (4 << 20) // Bytes ja lidos do arquivo de chegadas que podem sair da memoria
+#define BITS_SUB_BALDE 4     // Histogramas de latencia: 16 baldes por potencia de 2 (erro relativo < 1/16)
+#define EXPOENTE_MAXIMO 40   // Acima de 2^41 ns (~37 min) tudo cai no ultimo balde
+#define BALDES_LATENCIA ((EXPOENTE_MAXIMO - BITS_SUB_BALDE + 2) << BITS_SUB_BALDE)
+#define LOTE_RASTRO 4096     // Registros por write() no arquivo de rastro (64 KiB)
+#define INTERVALO_PAINEL_MS 100 // Periodo de publicacao do retrato em memoria compartilhada
+// Campos _Atomic que o painel (-m) le com a simulacao rodando. Cada um tem uma so thread que escreve,
+// entao ela le e grava relaxado: no x86 e o mesmo mov de um campo comum, sem instrucao com lock.
+#define LER_RELAXADO(x) atomic_load_explicit(&(x), memory_order_relaxed)
+#define GRAVAR_RELAXADO(x, v) atomic_store_explicit(&(x), (v), memory_order_relaxed)
+#define SOMAR_RELAXADO(x, n) GRAVAR_RELAXADO(x, LER_RELAXADO(x) + (n))
 
-typedef enum { DOMESTICO, INTERNACIONAL } TipoVoo;
-typedef enum { AGUARDANDO, POUSANDO, DESEMBARCANDO, DECOLANDO, CONCLUIDO, ACIDENTE } StatusVoo;
+// TipoVoo, StatusVoo, TipoRecurso, MensagemLog e RegistroLog ficam em rastro.h
+// ATOMICA: cada fase pede todos os seus recursos de uma vez e so comeca com todos juntos
+// INCREMENTAL: pega um recurso por vez, devolvendo tudo e tentando de novo no timeout
+// PRAZO: um escalonador central por aeroporto entrega os conjuntos pelo menor prazo de queda
+typedef enum { POLITICA_ATOMICA, POLITICA_INCREMENTAL, POLITICA_PRAZO } PoliticaAquisicao;
+// O que fazer quando o buffer do log enche: esperar espaco ou descartar e contar
+typedef enum { LOG_BLOQUEAR, LOG_DESCARTAR } PoliticaLog;
+// Estado de um gerador xoshiro128** (128 bits). Cada voo tem o seu, derivado da semente mestra.
+typedef struct {
+    uint32_t s[4];
+} GeradorAleatorio;
+
+// Cada voo e uma maquina de estados: o status diz a fase e os campos abaixo guardam onde parou.
+// Os eventos de um voo sempre rodam no mesmo worker, entao so ele mexe no proprio estado.
+// A excecao sao os campos da fila de espera, que quem libera o recurso altera com o mutex do recurso.
+typedef struct InfoVoo {
+    int id;                         // Ordem de criacao, indexa o resumo da tabela de voos
+    int codigo;                     // Numero do voo nos logs: o do arquivo de chegadas, ou o proprio id
+    TipoVoo tipo;
+    StatusVoo status;
+    int eCritico;
+    int64_t inicioDaEspera;         // Inicio da fase atual, de onde contam fome e queda; ns no relogio da simulacao
+    int64_t alertaAgendado, quedaAgendada; // Instante do EV_ALERTA_FOME/EV_QUEDA que vale; os outros sao ignorados
+    int64_t inicioDaFase;           // Pedido dos recursos da fase, para a latencia de pouso/decolagem
+    int64_t inicioDoServico;        // Conseguiu todos os recursos da fase
+    unsigned int recursosPedidos;   // Recursos da fase ja pedidos ao menos uma vez (mascara por TipoRecurso)
+    int64_t pedidoDoRecurso[NUM_RECURSOS], concessaoDoRecurso[NUM_RECURSOS];
+    int passo;                      // Indice do proximo recurso na ordem de aquisicao da fase
+    unsigned int recursosEmPosse;   // Mascara de bits indexada por TipoRecurso
+    atomic_int esperandoRecurso;    // Recurso em cuja fila o voo esta (-1 se nao esta esperando)
+    int filaDeEspera;               // 0 -> Criticos; 1 -> Internacionais; 2 -> Domesticos
+    unsigned int tentativa;         // Muda a cada espera para descartar timeouts antigos
+    struct InfoVoo *proximoNaFila, *anteriorNaFila;
+    GeradorAleatorio gerador;       // Tipo do voo e backoff; so o worker do voo usa
+    atomic_int eventosPendentes;    // Eventos do voo na agenda; o InfoVoo so e reaproveitado com zero
+    // Rede de aeroportos (-n): onde o voo esta (ou para onde voa) e quantos trechos faltam
+    int aeroporto;
+    int trechosRestantes;
+    atomic_uint trecho;             // Muda a cada decolagem para a rede; eventos de trechos antigos sao ignorados
+    int64_t chegadaPrevista;        // Instante do pouso no destino, enquanto o voo esta na caixa de entrada
+    int64_t prioridade;             // Escalonador: prazo de queda menos a vantagem da classe
+} InfoVoo;
+
+typedef struct {
+    InfoVoo *inicio, *fim;
+    int tamanho;
+} FilaVoos;
+
+// Um recurso do aeroporto: um pool de unidades iguais com mutex, filas por prioridade e contadores
+// proprios. Todos os tipos (Pista, Portao, Torre) usam o mesmo codigo, indexados por TipoRecurso.
+// Cada pool comeca numa linha de cache propria, entao disputar o mutex da Torre nao invalida a
+// linha da Pista nem a do Portao (falso compartilhamento).
+typedef struct {
+    _Alignas(64) pthread_mutex_t mutex;
+    int capacidade, disponivel;
+    int deficit;                              // Unidades em uso alem da capacidade: somem ao ser devolvidas
+    int esperandoCritico, esperandoInternacional;
+    FilaVoos filas[3];                        // [0] -> Criticos; [1] -> Internacionais; [2] -> Domesticos
+    // Copia de disponivel e das filas para o painel, gravada ao destravar o mutex: o painel nao trava
+    _Atomic int disponivelPublicado, esperandoPublicado[3];
+} PoolDeRecurso;
+
+// Uso do mutex de um recurso, medido em tempo real (CLOCK_MONOTONIC) mesmo no modo de eventos
+typedef struct {
+    long aquisicoes, aquisicoesDisputadas; // Disputada: o mutex ja estava travado por outra thread
+    int64_t esperaTotalNs, esperaMaximaNs; // Tempo bloqueado no pthread_mutex_lock
+    int64_t posseTotalNs;                  // Tempo entre travar e destravar
+    long liberacoesPorBackoff;             // Unidades devolvidas por timeout na politica incremental
+} PerfilRecurso;
+
+// Histograma com baldes logaritmicos, como o HdrHistogram: abaixo de 16 ns um balde por ns, e depois
+// 16 baldes por potencia de 2. Cobre de ns a minutos com o mesmo erro relativo e tamanho fixo.
+typedef struct {
+    long contagem;
+    int64_t maximoNs;
+    long baldes[BALDES_LATENCIA];
+} HistogramaLatencia;
+
+// Os campos _Atomic sao os que o painel le; o worker da fatia os atualiza com SOMAR_RELAXADO
+typedef struct {
+    _Atomic int voosSucesso, voosAcidentados, deadlocksEvitados, alertasDeStarvation;
+    // Latencia de pouso/decolagem: do pedido dos recursos ao fim da operacao
+    int64_t somaLatenciaPousoNs, somaLatenciaDecolagemNs;
+    int pousosConcluidos, decolagensConcluidas;
+    int64_t duracaoTotalNs; // Do inicio ao ultimo voo terminado; nas fatias, o ultimo que o worker terminou
+    int picoDeVoosAtivos;
+    // Quantas vezes um voo na fila foi acordado para tentar de novo, e quantas unidades foram concedidas
+    _Atomic long despertares, concessoes;
+    // Espera de cada fase: do pedido dos recursos ate conseguir todos
+    _Atomic int64_t somaEsperaNs;
+    _Atomic long esperasConcluidas;
+    // Espera: do pedido a concessao; servico: da concessao ao fim da fase, quando os recursos sao devolvidos.
+    // So contam as fases concluidas. Por recurso, a espera comeca no primeiro pedido dele na fase.
+    HistogramaLatencia esperaDaFase[NUM_FASES][2], servicoDaFase[NUM_FASES][2]; // [fase][TipoVoo]
+    HistogramaLatencia esperaPeloRecurso[NUM_RECURSOS], posseDoRecurso[NUM_RECURSOS];
+    PerfilRecurso perfil[NUM_RECURSOS];
+    // Saldo de voos em cada StatusVoo nesta fatia (um voo nasce numa fatia e muda de status em outra)
+    _Atomic long voosPorSituacao[NUM_SITUACOES];
+    // Rede: decolagens para outro aeroporto, e aeroportos processados por um worker que nao e o dono
+    long trechosVoados, aeroportosRoubados;
+} Estatisticas;
+
+// Cada worker conta na sua fatia, sem trava; o relatorio soma as fatias no final.
+// O alinhamento deixa cada fatia em linhas de cache proprias, sem falso compartilhamento.
+typedef struct {
+    _Alignas(64) Estatisticas contadores;
+    int64_t instanteDaTrava[NUM_RECURSOS]; // Quando esta thread travou cada mutex de recurso
+} FatiaEstatisticas;
+
+// EV_PROXIMA_CHEGADA cria o proximo voo; os demais eventos pertencem a um voo
+typedef enum { EV_PROXIMA_CHEGADA, EV_CHEGADA, EV_DESPERTAR, EV_FIM_FASE, EV_TIMEOUT, EV_NOVA_TENTATIVA, EV_ALERTA_FOME, EV_QUEDA } TipoEvento;
+
+typedef struct {
+    int64_t instante;       // Instante no relogio da simulacao (ns)
+    uint64_t sequencia;     // Desempate: eventos do mesmo instante saem na ordem em que foram agendados
+    TipoEvento tipo;
+    InfoVoo *voo;           // NULL para EV_PROXIMA_CHEGADA
+    unsigned int tentativa; // Usado pelo EV_TIMEOUT para saber se a espera ainda e a mesma
+    unsigned int trecho;    // Trecho do voo quando o evento foi agendado
+} Evento;
+
+// Fila de prioridade (heap minimo) de eventos. Cada worker tem a sua; no modo de eventos ha so uma.
+typedef struct {
+    Evento *eventos;
+    size_t tamanho, capacidade;
+    uint64_t proximaSequencia;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;    // Acorda o worker quando chega um evento mais cedo que o primeiro
+    struct Simulacao *simulacao;
+} FilaDeEventos;
+
+// Um aeroporto da rede, com recursos proprios. No modo de eventos tambem tem agenda e relogio
+// proprios: e um processo logico que so recebe voos pela caixa de entrada.
+typedef struct {
+    PoolDeRecurso recursos[NUM_RECURSOS];
+    // Escalonador (-p prazo): pedidos pendentes em ordem de prioridade, encadeados por proximoNaFila,
+    // e quantos esperam por recurso e classe (para o painel). Protegido pelos mutexes de todos os recursos.
+    FilaVoos pendentes;
+    int esperandoNoEscalonador[NUM_RECURSOS][3];
+    FilaDeEventos agenda;
+    _Atomic int64_t relogioNs;
+    // Pilha sem trava (Treiber) dos voos que decolaram para ca, encadeados por proximoNaFila.
+    // Varios workers empilham; so o coordenador esvazia, entre janelas, de uma vez (sem ABA).
+    _Alignas(64) _Atomic(InfoVoo*) caixaDeEntrada;
+} Aeroporto;
+
+// Aeroportos de um worker numa janela da rede. O dono pega da frente; quem terminou os seus pega daqui tambem.
+typedef struct {
+    _Alignas(64) atomic_int proximo;
+    int quantidade;
+    int *aeroportos;
+} ListaDeTrabalho;
+
+// Um bloco da tabela de voos: so o resumo que o relatorio le (codigo, tipo e status final).
+// O estado da maquina de estados (InfoVoo) fica na reserva de voos e e reaproveitado.
+typedef struct {
+    int32_t *codigos;     // Escrito na criacao
+    uint8_t *tipos;       // TipoVoo, escrito na criacao
+    uint8_t *situacoes;   // StatusVoo, escrito na criacao e quando o voo termina
+} BlocoDeVoos;
+
+// InfoVoo dos voos em andamento. Um voo terminado volta para a lista de livres quando o ultimo
+// evento dele sai da agenda, entao a memoria acompanha o pico de voos ativos, nao o total de voos.
+typedef struct {
+    InfoVoo **lotes;      // Para liberar no final; os lotes nunca mudam de lugar
+    int numeroDeLotes, capacidadeDeLotes;
+    InfoVoo *livres;      // Encadeados por proximoNaFila
+    pthread_mutex_t mutex;
+} ReservaDeVoos;
+
+// Arquivo de chegadas mapeado com mmap e lido um registro por vez, conforme os voos chegam.
+// CSV: chegada_ms,codigo,tipo[,prioridade], com tipo D/I (ou 0/1) e prioridade 1 ou C para critico.
+// Linhas vazias, comentarios (#) e o cabecalho sao pulados.
+// Binario: "VOOS" + uint32 versao 1, depois registros de 16 bytes little-endian:
+// int64 chegada_ms, int32 codigo, uint8 tipo, uint8 prioridade, 2 bytes livres.
+typedef struct {
+    const char *dados;
+    size_t tamanho, posicao;
+    size_t descartadoAte; // As paginas antes daqui ja foram devolvidas com MADV_DONTNEED
+    int binario;
+    long linhasIgnoradas;
+    int64_t ultimoInstanteNs; // Registros fora de ordem sao adiados para este instante
+} ArquivoDeChegadas;
+
+typedef struct {
+    int64_t instanteNs;
+    int codigo;
+    TipoVoo tipo;
+    int critico;
+} RegistroDeChegada;
+
+// Parametros de uma simulacao. Os #define acima sao so os valores padrao.
+typedef struct {
+    int capacidade[NUM_RECURSOS];   // Unidades de cada recurso em cada aeroporto
+    int alertaFomeSegundos, quedaAviaoSegundos;
+    double fracaoInternacional;     // Parte dos voos que e internacional (1 em 3 por padrao)
+    int duracaoSegundos;
+    int64_t intervaloChegadasNs;
+    PoliticaAquisicao politica;
+    double variacaoChegadas;        // Fracao do intervalo sorteada para mais ou para menos em cada chegada
+    uint64_t semente;               // Semente mestra: a mesma semente repete a simulacao
+    const char *arquivoDeChegadas;  // Se houver, as chegadas vem dele em vez do intervalo fixo
+    int numeroDeAeroportos;         // Mais de um: rede, e os voos voam trechosPorVoo trechos entre eles
+    int trechosPorVoo;
+} Configuracao;
+
+// Todo o estado de uma simulacao. Cada thread trabalha na simulacao apontada por simulacao,
+// entao varias simulacoes independentes podem rodar ao mesmo tempo (modo de varredura).
+typedef struct Simulacao {
+    Configuracao config;
+    Aeroporto *aeroportos;          // config.numeroDeAeroportos, cada um com os proprios recursos
+    Estatisticas estatisticas;      // So e preenchida no relatorio, somando as fatias
+    FatiaEstatisticas *fatias;      // Uma por worker
+    BlocoDeVoos blocosDeVoos[MAX_BLOCOS_DE_VOOS]; // Diretorio fixo: os blocos nunca mudam de lugar
+    ReservaDeVoos reservaDeVoos;
+    _Atomic int totalDeVoosCriados;
+    GeradorAleatorio geradorDeChegadas;
+    ArquivoDeChegadas chegadas;     // Aberto so com config.arquivoDeChegadas
+    RegistroDeChegada proximaChegada;
+    int haProximaChegada;
+    FilaDeEventos *agendas;
+    int numeroDeWorkers;
+    _Atomic int64_t relogioVirtualNs; // Instante atual no modo de eventos discretos (na rede, o inicio da janela)
+    _Atomic int64_t inicioRealNs;     // CLOCK_MONOTONIC no inicio da simulacao em tempo real
+    // Controle de termino do pool de workers
+    atomic_int voosEmAndamento;
+    atomic_int chegadasEncerradas;
+    atomic_int simulacaoEncerrada;
+    // Rede no modo de eventos: janela atual, trabalho de cada worker e barreira entre janelas
+    int64_t horizonteNs;
+    ListaDeTrabalho *listas;
+    pthread_barrier_t barreira;
+    int redeEncerrada;
+    long janelas;
+    // Instantaneos (-g e -c)
+    int restaurada;                 // Continua de um instantaneo: nao comeca do zero
+    int64_t proximoInstantaneoNs;
+    pid_t gravadorDoInstantaneo;    // Processo filho gravando o ultimo instantaneo
+    int instantaneosGravados;
+    int64_t pausaDosInstantaneosNs; // Tempo real gasto nos fork()
+} Simulacao;
+
+_Thread_local Simulacao *simulacao;
+_Thread_local int indiceDoWorker = 0;
+_Thread_local _Atomic int64_t *relogioVirtual; // O que agoraNs() le no modo de eventos: o da simulacao ou o do aeroporto
+// Opcoes de linha de comando
+int modoEventos = 0;         // -e: usa relogio virtual em vez do relogio real
+int modoSilencioso = 0;      // -q: nao imprime eventos nem o estado de cada voo
+int modoVarredura = 0;       // -v: varias simulacoes em paralelo, so a tabela final
+PoliticaLog politicaLog = LOG_BLOQUEAR;         // -l bloquear|descartar
+const char *caminhoDoRastro = NULL;  // -r: grava o rastro binario dos eventos neste arquivo
+const char *nomeDoPainel = NULL;     // -m: publica o retrato da simulacao nesta memoria compartilhada
+const char *caminhoDoInstantaneo = NULL; // -g: grava o estado da simulacao neste arquivo periodicamente
+int64_t intervaloDoInstantaneoNs = 0;    // em tempo simulado
+const char *instantaneoDeOrigem = NULL;  // -c: as simulacoes continuam deste instantaneo
+int rastreando = 0;
+Configuracao configuracaoBase = {
+    { 0 },                                   // Capacidades: tiposDeRecurso
+    ALERTA_FOME_SEGUNDOS, QUEDA_AVIAO_SEGUNDOS, 1.0 / 3,
+    TEMPO_SIMULACAO_MINUTOS * 60,            // -t <minutos>
+    TEMPO_BASE_OPERACAO * NS_POR_SEGUNDO,    // -i <milissegundos>
+    POLITICA_ATOMICA,                        // -p atomica|incremental|prazo
+    0.0,                                     // -j <porcentagem>
+    0,                                       // -s <semente>
+    NULL,                                    // -a <arquivo>
+    1, TRECHOS_POR_VOO                       // -n <aeroportos>[:<trechos>]
+};
+// Tipos de recurso de cada aeroporto. Um tipo novo (caminhao de combustivel, degelo, pista de taxi) e
+// um valor em TipoRecurso e um nome em nomesDosRecursos (rastro.h), uma linha aqui e o lugar dele nas
+// ordens de aquisicao e liberacao das fases. Filas, travas, painel e estatisticas nao mudam.
+static const struct {
+    int capacidadePadrao;
+    const char *noRelatorio;
+} tiposDeRecurso[NUM_RECURSOS] = {
+    [PISTA] = { NUMERO_PISTAS, "Pistas disponiveis" },
+    [PORTAO] = { NUMERO_PORTOES, "Portoes disponiveis" },
+    [TORRE] = { CAPACIDADE_TORRE, "Capacidade da Torre" },
+};
+
+void inicializarAeroporto();
+void destruirAeroporto();
+void liberarTabelaDeVoos();
+void abrirArquivoDeChegadas(ArquivoDeChegadas *arquivo, const char *caminho);
+int lerProximaChegada(ArquivoDeChegadas *arquivo, RegistroDeChegada *registro);
+int64_t ultimaChegadaNs(const ArquivoDeChegadas *arquivo);
+void fecharArquivoDeChegadas(ArquivoDeChegadas *arquivo);
+Simulacao* criarSimulacao(const Configuracao *config, int workers);
+void descartarSimulacao();
+int executarVarredura(const char *especificacao, int threads);
+int executarBancada(long duracaoMs, int threads);
+void imprimirRelatorioFinal();
+void logEvento(const InfoVoo *voo, MensagemLog mensagem);
+void registrarLog(const InfoVoo *voo, MensagemLog mensagem, int recurso);
+void iniciarLog();
+void finalizarLog();
+void iniciarPainel();
+void finalizarPainel();
+void liberarRecurso(TipoRecurso tipo, InfoVoo *voo);
+void agendarEvento(int64_t instante, TipoEvento tipo, InfoVoo *voo);
+void processarEvento(const Evento *evento);
+void registrarLatencia(StatusVoo fase, int64_t inicioNs);
+void registrarEspera(const InfoVoo *voo, int64_t agora);
+void registrarServico(const InfoVoo *voo, unsigned int conjunto, int64_t agora);
+void agregarEstatisticas();
+int64_t percentilDaEspera(const Estatisticas *e, double p);
+int64_t agoraNs();
+const char* getStatusEmTexto(StatusVoo status);
+void executarSimulacaoEventos();
+void executarSimulacaoTempoReal();
+void gravarInstantaneoSeVenceu();
+void esperarGravacaoDoInstantaneo();
+void abrirInstantaneo(const char *caminho, Configuracao *config);
+void restaurarInstantaneo();
+
+int main(int argc, char *argv[]) {
+    int opcao;
+    int numeroDeWorkers = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    const char *varredura = NULL;
+    long bancadaMs = 0;
+    int sementeInformada = 0, duracaoInformada = 0;
+    for (int r = 0; r < NUM_RECURSOS; r++) configuracaoBase.capacidade[r] = tiposDeRecurso[r].capacidadePadrao;
+    while ((opcao = getopt(argc, argv, "eqt:p:i:w:l:v:s:j:a:r:m:n:b:g:c:")) != -1) {
+        switch (opcao) {
+            case 'e': modoEventos = 1; break;
+            case 'q': modoSilencioso = 1; break;
+            case 't': configuracaoBase.duracaoSegundos = atoi(optarg) * 60; duracaoInformada = 1; break;
+            case 'i': configuracaoBase.intervaloChegadasNs = atoll(optarg) * NS_POR_MILISSEGUNDO; break;
+            case 'w': numeroDeWorkers = atoi(optarg); break;
+            case 'v': varredura = optarg; break;
+            case 's': configuracaoBase.semente = strtoull(optarg, NULL, 10); sementeInformada = 1; break;
+            case 'j': configuracaoBase.variacaoChegadas = atof(optarg) / 100.0; break;
+            case 'a': configuracaoBase.arquivoDeChegadas = optarg; break;
+            case 'r': caminhoDoRastro = optarg; break;
+            case 'm': nomeDoPainel = optarg; break;
+            case 'b': bancadaMs = atol(optarg); if (bancadaMs <= 0) goto uso; break;
+            case 'c': instantaneoDeOrigem = optarg; modoEventos = 1; break;
+            case 'g': {
+                // arquivo[:segundos], padrao a cada 60 s simulados
+                char *separador = strrchr(optarg, ':');
+                long segundos = separador != NULL ? atol(separador + 1) : 60;
+                if (separador != NULL) *separador = '\0';
+                if (segundos <= 0 || *optarg == '\0') goto uso;
+                caminhoDoInstantaneo = optarg;
+                intervaloDoInstantaneoNs = segundos * NS_POR_SEGUNDO;
+                break;
+            }
+            case 'n':
+                configuracaoBase.numeroDeAeroportos = atoi(optarg);
+                if (strchr(optarg, ':') != NULL) configuracaoBase.trechosPorVoo = atoi(strchr(optarg, ':') + 1);
+                if (configuracaoBase.numeroDeAeroportos < 1 || configuracaoBase.numeroDeAeroportos > RASTRO_MAX_AEROPORTOS ||
+                    configuracaoBase.trechosPorVoo < 1) goto uso;
+                break;
+            case 'p':
+                if (strcmp(optarg, "atomica") == 0) { configuracaoBase.politica = POLITICA_ATOMICA; break; }
+                if (strcmp(optarg, "incremental") == 0) { configuracaoBase.politica = POLITICA_INCREMENTAL; break; }
+                if (strcmp(optarg, "prazo") == 0) { configuracaoBase.politica = POLITICA_PRAZO; break; }
+                goto uso;
+            case 'l':
+                if (strcmp(optarg, "bloquear") == 0) { politicaLog = LOG_BLOQUEAR; break; }
+                if (strcmp(optarg, "descartar") == 0) { politicaLog = LOG_DESCARTAR; break; }
+                goto uso;
+            default:
+            uso:
+                fprintf(stderr, "Uso: %s [-e] [-q] [-t minutos] [-p atomica|incremental|prazo] [-i ms] [-w workers] [-l bloquear|descartar] [-v varredura] [-s semente] [-j %%] [-a arquivo] [-r rastro] [-m /nome] [-n aeroportos[:trechos]] [-b ms] [-g arquivo[:s]] [-c arquivo]\n", argv[0]);
+                fprintf(stderr, "  -e  simulacao por eventos discretos (relogio virtual)\n");
+                fprintf(stderr, "  -q  nao imprime os eventos nem o estado final de cada voo\n");
+                fprintf(stderr, "  -t  duracao da simulacao em minutos (padrao %d)\n", TEMPO_SIMULACAO_MINUTOS);
+                fprintf(stderr, "  -p  politica de aquisicao de recursos (padrao atomica); prazo: escalonador central que\n");
+                fprintf(stderr, "      entrega os conjuntos pelo menor prazo de queda, criticos e internacionais na frente\n");
+                fprintf(stderr, "  -i  intervalo entre chegadas em milissegundos (padrao %d)\n", TEMPO_BASE_OPERACAO * 1000);
+                fprintf(stderr, "  -w  threads do pool no modo em tempo real (padrao: numero de nucleos)\n");
+                fprintf(stderr, "  -l  buffer de log cheio: espera espaco ou descarta (padrao bloquear)\n");
+                fprintf(stderr, "  -s  semente mestra; a mesma semente repete os tipos, chegadas e backoffs (padrao: relogio)\n");
+                fprintf(stderr, "  -j  variacao aleatoria de cada intervalo entre chegadas, em %% (padrao 0)\n");
+                fprintf(stderr, "  -a  reproduz as chegadas de um arquivo CSV (chegada_ms,codigo,D|I[,C]) ou binario;\n");
+                fprintf(stderr, "      sem -t, a simulacao dura ate a ultima chegada do arquivo\n");
+                fprintf(stderr, "  -r  grava o rastro binario de todos os eventos (ver rastro.h e analisador.c)\n");
+                fprintf(stderr, "  -m  publica o estado a cada %d ms na memoria compartilhada /nome (ler com o monitor)\n", INTERVALO_PAINEL_MS);
+                fprintf(stderr, "  -n  rede de ate %d aeroportos; cada voo voa trechos entre eles (padrao %d) de %d a %d s.\n",
+                        RASTRO_MAX_AEROPORTOS, TRECHOS_POR_VOO, TEMPO_DE_VOO_MINIMO, TEMPO_DE_VOO_MAXIMO);
+                fprintf(stderr, "      Com -e, os aeroportos sao divididos entre -w workers\n");
+                fprintf(stderr, "  -v  varredura de parametros por eventos discretos, -w simulacoes em paralelo. Ex.:\n");
+                fprintf(stderr, "      pistas=2:4,portoes=4:6,torre=2,fome=60,queda=90,internacional=0.2:0.5:0.1,sementes=8\n");
+                fprintf(stderr, "  -b  bancada: vazao da Pista com -w - 1 threads disputando a Torre, ms por medida\n");
+                fprintf(stderr, "  -g  com -e, grava o estado completo a cada s segundos simulados (padrao 60)\n");
+                fprintf(stderr, "  -c  continua a simulacao gravada com -g (implica -e); a configuracao vem do arquivo,\n");
+                fprintf(stderr, "      so -t e -s a trocam. Com -v, cada rodada parte do mesmo instantaneo\n");
+                return 1;
+        }
+    }
+    if (configuracaoBase.intervaloChegadasNs <= 0) configuracaoBase.intervaloChegadasNs = NS_POR_MILISSEGUNDO;
+    if (configuracaoBase.variacaoChegadas < 0) configuracaoBase.variacaoChegadas = 0;
+    if (configuracaoBase.variacaoChegadas > 1) configuracaoBase.variacaoChegadas = 1;
+    if (numeroDeWorkers < 1) numeroDeWorkers = 1;
+    if (caminhoDoInstantaneo != NULL && (!modoEventos || varredura != NULL)) {
+        fprintf(stderr, "-g so vale no modo de eventos (-e), sem varredura\n");
+        return 1;
+    }
+    if (instantaneoDeOrigem != NULL) {
+        Configuracao salva;
+        abrirInstantaneo(instantaneoDeOrigem, &salva);
+        if (duracaoInformada) salva.duracaoSegundos = configuracaoBase.duracaoSegundos;
+        if (sementeInformada) salva.semente = configuracaoBase.semente;
+        configuracaoBase = salva;
+        sementeInformada = duracaoInformada = 1;
+    }
+    if (!sementeInformada) configuracaoBase.semente = time(NULL);
+    if (configuracaoBase.arquivoDeChegadas != NULL && !duracaoInformada) {
+        // Sem -t, vai ate a ultima chegada (arredondada para cima) e todos os voos do arquivo entram
+        ArquivoDeChegadas arquivo;
+        abrirArquivoDeChegadas(&arquivo, configuracaoBase.arquivoDeChegadas);
+        configuracaoBase.duracaoSegundos = (int)(ultimaChegadaNs(&arquivo) / NS_POR_SEGUNDO) + 1;
+        fecharArquivoDeChegadas(&arquivo);
+    }
+    if (bancadaMs > 0) return executarBancada(bancadaMs, numeroDeWorkers);
+    if (varredura != NULL) return executarVarredura(varredura, numeroDeWorkers);
+    // No modo de eventos so a rede usa mais de uma thread, e no maximo uma por aeroporto
+    if (modoEventos && numeroDeWorkers > configuracaoBase.numeroDeAeroportos) numeroDeWorkers = configuracaoBase.numeroDeAeroportos;
+    if (caminhoDoRastro != NULL) {
+        rastreando = 1;
+        politicaLog = LOG_BLOQUEAR; // Um rastro com buracos nao serve para reconstruir as filas
+    }
+    criarSimulacao(&configuracaoBase, numeroDeWorkers);
+    if (instantaneoDeOrigem != NULL) restaurarInstantaneo();
+    printf("--- Simulacao De controle de Trafego Aereo ---\n");
+    printf("--- Ordem de Prioridade: 1.Critico -> 2.Internacional -> 3.Domestico ---\n");
+    printf("--- Semente: %llu (use -s %llu para repetir) ---\n",
+           (unsigned long long)configuracaoBase.semente, (unsigned long long)configuracaoBase.semente);
+    if (configuracaoBase.arquivoDeChegadas != NULL) {
+        printf("--- Chegadas: %s (%s, %d s) ---\n", configuracaoBase.arquivoDeChegadas,
+               simulacao->chegadas.binario ? "binario" : "CSV", configuracaoBase.duracaoSegundos);
+    }
+    if (instantaneoDeOrigem != NULL) {
+        printf("--- Continuando do instantaneo %s em %.0f s, com %d voos criados ---\n", instantaneoDeOrigem,
+               (double)simulacao->relogioVirtualNs / NS_POR_SEGUNDO, simulacao->totalDeVoosCriados);
+    }
+    if (configuracaoBase.numeroDeAeroportos > 1) {
+        printf("--- Rede: %d aeroportos, %d trechos por voo, %d workers ---\n", configuracaoBase.numeroDeAeroportos,
+               configuracaoBase.trechosPorVoo, numeroDeWorkers);
+    }
+
+    iniciarLog(); // Cada modo chama finalizarLog() quando o ultimo voo termina
+    if (nomeDoPainel != NULL) iniciarPainel();
+    if (modoEventos) executarSimulacaoEventos();
+    else executarSimulacaoTempoReal();
+    if (nomeDoPainel != NULL) finalizarPainel();
+    imprimirRelatorioFinal();
+    descartarSimulacao();
+    return 0;
+}
+
+// ---========= GERADOR ALEATORIO =========---
+// Nada de rand(): cada voo tem um xoshiro128** proprio, e as chegadas tem outro. Todos saem da
+// semente mestra pelo splitmix64, com o id do voo como numero do fluxo. Assim o voo N sorteia
+// sempre os mesmos valores para a mesma semente, nao importa o worker nem a ordem dos eventos.
+
+static uint64_t splitmix64(uint64_t *x) {
+    uint64_t z = (*x += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static void semearGerador(GeradorAleatorio *gerador, uint64_t semente, uint64_t fluxo) {
+    uint64_t x = semente ^ (fluxo * 0xD1B54A32D192ED03ULL);
+    uint64_t a = splitmix64(&x), b = splitmix64(&x);
+    gerador->s[0] = (uint32_t)a;
+    gerador->s[1] = (uint32_t)(a >> 32);
+    gerador->s[2] = (uint32_t)b;
+    gerador->s[3] = (uint32_t)(b >> 32);
+}
+
+static inline uint32_t rotacionar(uint32_t x, int k) {
+    return (x << k) | (x >> (32 - k));
+}
+
+static uint32_t proximoAleatorio(GeradorAleatorio *gerador) {
+    uint32_t *s = gerador->s;
+    uint32_t resultado = rotacionar(s[1] * 5, 7) * 9;
+    uint32_t t = s[1] << 9;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotacionar(s[3], 11);
+    return resultado;
+}
+
+// Uniforme em [0, 1)
+static double aleatorioUniforme(GeradorAleatorio *gerador) {
+    return proximoAleatorio(gerador) * (1.0 / 4294967296.0);
+}
+
+// ---========= ARQUIVO DE CHEGADAS =========---
+// O arquivo e mapeado inteiro, mas lido so quando a proxima chegada e necessaria. As paginas ja
+// lidas sao devolvidas ao kernel a cada JANELA_DE_LEITURA bytes, entao um arquivo de milhoes de
+// linhas ocupa no maximo alguns MB de memoria, e nada e lido antes da hora.
+
+#define TAMANHO_CABECALHO_BINARIO 8
+#define TAMANHO_REGISTRO_BINARIO 16
+
+static int64_t lerInteiroLE(const unsigned char *bytes, int tamanho) {
+    uint64_t valor = 0;
+    for (int i = tamanho - 1; i >= 0; i--) valor = (valor << 8) | bytes[i];
+    if (tamanho < 8 && (valor >> (8 * tamanho - 1))) valor |= ~(uint64_t)0 << (8 * tamanho); // Sinal
+    return (int64_t)valor;
+}
+
+static void pularEspacos(const char **c, const char *fim) {
+    while (*c < fim && (**c == ' ' || **c == '\t' || **c == '\r')) (*c)++;
+}
+
+// Le um inteiro e o separador depois dele (virgula ou fim da linha)
+static int lerCampoInteiro(const char **c, const char *fim, int64_t *valor) {
+    int negativo = 0;
+    int64_t v = 0;
+    pularEspacos(c, fim);
+    if (*c < fim && **c == '-') { negativo = 1; (*c)++; }
+    if (*c == fim || **c < '0' || **c > '9') return 0;
+    while (*c < fim && **c >= '0' && **c <= '9') v = v * 10 + (*(*c)++ - '0');
+    pularEspacos(c, fim);
+    if (*c < fim && *(*c)++ != ',') return 0;
+    *valor = negativo ? -v : v;
+    return 1;
+}
+
+// Primeiro caractere de um campo de texto; avanca ate depois da virgula
+static char lerCampoTexto(const char **c, const char *fim) {
+    pularEspacos(c, fim);
+    char letra = *c < fim ? **c : '\0';
+    while (*c < fim && **c != ',') (*c)++;
+    if (*c < fim) (*c)++;
+    return letra;
+}
+
+// 1: registro valido; 0: linha vazia, comentario ou cabecalho; -1: linha invalida
+static int lerLinhaCSV(const char *c, const char *fim, int primeiraLinha, RegistroDeChegada *registro) {
+    int64_t chegadaMs, codigo;
+    pularEspacos(&c, fim);
+    if (c == fim || *c == '#') return 0;
+    if (primeiraLinha && (*c < '0' || *c > '9') && *c != '-') return 0;
+    if (!lerCampoInteiro(&c, fim, &chegadaMs) || !lerCampoInteiro(&c, fim, &codigo)) return -1;
+    switch (lerCampoTexto(&c, fim)) {
+        case 'D': case 'd': case '0': registro->tipo = DOMESTICO; break;
+        case 'I': case 'i': case '1': registro->tipo = INTERNACIONAL; break;
+        default: return -1;
+    }
+    char prioridade = lerCampoTexto(&c, fim);
+    registro->critico = prioridade == '1' || prioridade == 'C' || prioridade == 'c';
+    registro->instanteNs = chegadaMs * NS_POR_MILISSEGUNDO;
+    registro->codigo = (int)codigo;
+    return 1;
+}
+
+static int lerRegistroBinario(const unsigned char *bytes, RegistroDeChegada *registro) {
+    if (bytes[12] > INTERNACIONAL) return -1;
+    registro->instanteNs = lerInteiroLE(bytes, 8) * NS_POR_MILISSEGUNDO;
+    registro->codigo = (int)lerInteiroLE(bytes + 8, 4);
+    registro->tipo = bytes[12];
+    registro->critico = bytes[13] != 0;
+    return 1;
+}
+
+void abrirArquivoDeChegadas(ArquivoDeChegadas *arquivo, const char *caminho) {
+    memset(arquivo, 0, sizeof(*arquivo));
+    int fd = open(caminho, O_RDONLY);
+    if (fd < 0) { perror(caminho); exit(1); }
+    struct stat info;
+    if (fstat(fd, &info) < 0) { perror("fstat"); exit(1); }
+    arquivo->tamanho = info.st_size;
+    if (arquivo->tamanho > 0) {
+        void *dados = mmap(NULL, arquivo->tamanho, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (dados == MAP_FAILED) { perror("mmap"); exit(1); }
+        madvise(dados, arquivo->tamanho, MADV_SEQUENTIAL); // Leitura antecipada maior no kernel
+        arquivo->dados = dados;
+    }
+    close(fd); // O mapeamento continua valido
+    if (arquivo->tamanho >= TAMANHO_CABECALHO_BINARIO && memcmp(arquivo->dados, "VOOS", 4) == 0) {
+        if (lerInteiroLE((const unsigned char*)arquivo->dados + 4, 4) != 1) {
+            fprintf(stderr, "%s: versao do formato binario nao suportada\n", caminho);
+            exit(1);
+        }
+        arquivo->binario = 1;
+        arquivo->posicao = TAMANHO_CABECALHO_BINARIO;
+    }
+}
+
+// Devolve as paginas que ficaram para tras. O mapeamento e so leitura, entao o kernel pode
+// descarta-las sem escrever nada; se alguem voltasse a le-las, viriam do arquivo de novo.
+static void descartarPaginasLidas(ArquivoDeChegadas *arquivo) {
+    if (arquivo->posicao - arquivo->descartadoAte < JANELA_DE_LEITURA) return;
+    size_t pagina = (size_t)sysconf(_SC_PAGESIZE);
+    size_t ate = arquivo->posicao & ~(pagina - 1);
+    madvise((void*)(arquivo->dados + arquivo->descartadoAte), ate - arquivo->descartadoAte, MADV_DONTNEED);
+    arquivo->descartadoAte = ate;
+}
+
+// Le o proximo registro valido. Devolve 0 no fim do arquivo.
+// O arquivo deve estar ordenado por chegada; um registro fora de ordem chega junto com o anterior.
+int lerProximaChegada(ArquivoDeChegadas *arquivo, RegistroDeChegada *registro) {
+    int resultado = 0;
+    while (resultado != 1) {
+        if (arquivo->binario) {
+            if (arquivo->posicao + TAMANHO_REGISTRO_BINARIO > arquivo->tamanho) return 0;
+            resultado = lerRegistroBinario((const unsigned char*)arquivo->dados + arquivo->posicao, registro);
+            arquivo->posicao += TAMANHO_REGISTRO_BINARIO;
+        } else {
+            if (arquivo->posicao >= arquivo->tamanho) return 0;
+            const char *inicio = arquivo->dados + arquivo->posicao;
+            const char *fim = memchr(inicio, '\n', arquivo->tamanho - arquivo->posicao);
+            if (fim == NULL) fim = arquivo->dados + arquivo->tamanho;
+            resultado = lerLinhaCSV(inicio, fim, arquivo->posicao == 0, registro);
+            arquivo->posicao = fim - arquivo->dados + 1;
+        }
+        if (resultado < 0) arquivo->linhasIgnoradas++;
+    }
+    if (registro->instanteNs < arquivo->ultimoInstanteNs) registro->instanteNs = arquivo->ultimoInstanteNs;
+    arquivo->ultimoInstanteNs = registro->instanteNs;
+    descartarPaginasLidas(arquivo);
+    return 1;
+}
+
+// Instante do ultimo registro, lendo so o fim do arquivo (para a duracao padrao com -a)
+int64_t ultimaChegadaNs(const ArquivoDeChegadas *arquivo) {
+    RegistroDeChegada registro;
+    if (arquivo->binario) {
+        size_t registros = (arquivo->tamanho - TAMANHO_CABECALHO_BINARIO) / TAMANHO_REGISTRO_BINARIO;
+        for (size_t i = registros; i > 0; i--) {
+            size_t posicao = TAMANHO_CABECALHO_BINARIO + (i - 1) * TAMANHO_REGISTRO_BINARIO;
+            if (lerRegistroBinario((const unsigned char*)arquivo->dados + posicao, &registro) == 1) return registro.instanteNs;
+        }
+        return 0;
+    }
+    // Volta linha por linha a partir do fim ate achar um registro valido
+    size_t fim = arquivo->tamanho;
+    while (fim > 0) {
+        size_t inicio = fim;
+        while (inicio > 0 && arquivo->dados[inicio - 1] != '\n') inicio--;
+        if (lerLinhaCSV(arquivo->dados + inicio, arquivo->dados + fim, inicio == 0, &registro) == 1) return registro.instanteNs;
+        fim = inicio > 0 ? inicio - 1 : 0;
+    }
+    return 0;
+}
+
+void fecharArquivoDeChegadas(ArquivoDeChegadas *arquivo) {
+    if (arquivo->dados != NULL) munmap((void*)arquivo->dados, arquivo->tamanho);
+    arquivo->dados = NULL;
+}
+
+// ---========= TABELA DE VOOS =========---
+// O bloco k guarda o resumo de VOOS_POR_BLOCO << k voos. A tabela cresce alocando um bloco novo,
+// sem copiar os anteriores. So o resumo (6 bytes por voo) cresce com o total de voos; os InfoVoo
+// saem da reserva e voltam para ela, entao um arquivo com milhoes de voos nao guarda milhoes de InfoVoo.
+
+static void localizarVoo(int indice, int *bloco, int *posicao) {
+    int k = 31 - __builtin_clz((unsigned int)(indice / VOOS_POR_BLOCO + 1));
+    *bloco = k;
+    *posicao = indice - VOOS_POR_BLOCO * ((1 << k) - 1);
+}
+
+// Aloca o bloco k do resumo, se ainda nao existe
+static void alocarResumo(int bloco) {
+    BlocoDeVoos *b = &simulacao->blocosDeVoos[bloco];
+    if (b->codigos == NULL) {
+        size_t tamanho = (size_t)VOOS_POR_BLOCO << bloco;
+        b->codigos = malloc(tamanho * sizeof(int32_t));
+        b->tipos = malloc(tamanho);
+        b->situacoes = malloc(tamanho);
+        if (b->codigos == NULL || b->tipos == NULL || b->situacoes == NULL) { perror("malloc"); exit(1); }
+    }
+}
+
+// Devolve um InfoVoo zerado para o voo de indice dado, com o resumo dele ja alocado.
+// So quem cria os voos chama; a reserva tem mutex porque os voos terminam em qualquer worker.
+static InfoVoo* alocarVoo(int indice) {
+    int bloco, posicao;
+    localizarVoo(indice, &bloco, &posicao);
+    alocarResumo(bloco);
+    ReservaDeVoos *reserva = &simulacao->reservaDeVoos;
+    pthread_mutex_lock(&reserva->mutex);
+    if (reserva->livres == NULL) {
+        if (reserva->numeroDeLotes == reserva->capacidadeDeLotes) {
+            reserva->capacidadeDeLotes = reserva->capacidadeDeLotes ? reserva->capacidadeDeLotes * 2 : 16;
+            reserva->lotes = realloc(reserva->lotes, reserva->capacidadeDeLotes * sizeof(InfoVoo*));
+            if (reserva->lotes == NULL) { perror("realloc"); exit(1); }
+        }
+        // Zerado: os InfoVoo livres tambem vao inteiros para os instantaneos
+        InfoVoo *lote = calloc(VOOS_POR_LOTE, sizeof(InfoVoo));
+        if (lote == NULL) { perror("calloc"); exit(1); }
+        reserva->lotes[reserva->numeroDeLotes++] = lote;
+        for (int i = 0; i < VOOS_POR_LOTE; i++) {
+            lote[i].proximoNaFila = reserva->livres;
+            reserva->livres = &lote[i];
+        }
+    }
+    InfoVoo *voo = reserva->livres;
+    reserva->livres = voo->proximoNaFila;
+    pthread_mutex_unlock(&reserva->mutex);
+    memset(voo, 0, sizeof(InfoVoo));
+    return voo;
+}
+
+// Chamado pelo worker do voo depois do ultimo evento de um voo terminado
+static void devolverVoo(InfoVoo *voo) {
+    ReservaDeVoos *reserva = &simulacao->reservaDeVoos;
+    pthread_mutex_lock(&reserva->mutex);
+    voo->proximoNaFila = reserva->livres;
+    reserva->livres = voo;
+    pthread_mutex_unlock(&reserva->mutex);
+}
+
+// Copia tipo e status para o resumo do bloco, que e o que o relatorio percorre
+static void atualizarResumoDoVoo(InfoVoo *voo) {
+    int bloco, posicao;
+    localizarVoo(voo->id - 1, &bloco, &posicao);
+    simulacao->blocosDeVoos[bloco].codigos[posicao] = voo->codigo;
+    simulacao->blocosDeVoos[bloco].tipos[posicao] = voo->tipo;
+    simulacao->blocosDeVoos[bloco].situacoes[posicao] = voo->status;
+}
+
+void liberarTabelaDeVoos() {
+    for (int i = 0; i < simulacao->reservaDeVoos.numeroDeLotes; i++) free(simulacao->reservaDeVoos.lotes[i]);
+    free(simulacao->reservaDeVoos.lotes);
+    for (int k = 0; k < MAX_BLOCOS_DE_VOOS && simulacao->blocosDeVoos[k].codigos != NULL; k++) {
+        free(simulacao->blocosDeVoos[k].codigos);
+        free(simulacao->blocosDeVoos[k].tipos);
+        free(simulacao->blocosDeVoos[k].situacoes);
+    }
+}
+
+// ---========= AGENDA DE EVENTOS =========---
+
+static int eventoAntesDe(const Evento *a, const Evento *b) {
+    if (a->instante != b->instante) return a->instante < b->instante;
+    return a->sequencia < b->sequencia;
+}
+
+// Agenda de quem processa os eventos do voo: todos os eventos de um voo vao para o mesmo worker.
+// Na rede vao para o aeroporto onde o voo esta: a agenda do aeroporto no modo de eventos, ou a do
+// worker dono do aeroporto em tempo real.
+static FilaDeEventos *agendaDoVoo(InfoVoo *voo) {
+    if (voo == NULL) return &simulacao->agendas[0];
+    if (simulacao->config.numeroDeAeroportos > 1) {
+        if (modoEventos) return &simulacao->aeroportos[voo->aeroporto].agenda;
+        return &simulacao->agendas[voo->aeroporto % simulacao->numeroDeWorkers];
+    }
+    return &simulacao->agendas[voo->id % simulacao->numeroDeWorkers];
+}
+
+void agendarEvento(int64_t instante, TipoEvento tipo, InfoVoo *voo) {
+    FilaDeEventos *agenda = agendaDoVoo(voo);
+    if (voo) atomic_fetch_add(&voo->eventosPendentes, 1);
+    pthread_mutex_lock(&agenda->mutex);
+    if (agenda->tamanho == agenda->capacidade) {
+        agenda->capacidade = agenda->capacidade ? agenda->capacidade * 2 : 1024;
+        agenda->eventos = realloc(agenda->eventos, agenda->capacidade * sizeof(Evento));
+        if (agenda->eventos == NULL) { perror("realloc"); exit(1); }
+    }
+    Evento novo = { instante, agenda->proximaSequencia++, tipo, voo, tipo == EV_TIMEOUT ? voo->tentativa : 0,
+                    voo ? atomic_load_explicit(&voo->trecho, memory_order_relaxed) : 0 };
+    // Sobe o evento no heap ate achar a posicao dele
+    size_t i = agenda->tamanho++;
+    while (i > 0) {
+        size_t pai = (i - 1) / 2;
+        if (!eventoAntesDe(&novo, &agenda->eventos[pai])) break;
+        agenda->eventos[i] = agenda->eventos[pai];
+        i = pai;
+    }
+    agenda->eventos[i] = novo;
+    // Virou o primeiro da fila: o worker pode estar dormindo ate um instante mais tarde
+    if (i == 0) pthread_cond_signal(&agenda->cond);
+    pthread_mutex_unlock(&agenda->mutex);
+}
+
+// Chamar com o mutex da agenda travado
+static int retirarEvento(FilaDeEventos *agenda, Evento *saida) {
+    if (agenda->tamanho == 0) return 0;
+    *saida = agenda->eventos[0];
+    Evento ultimo = agenda->eventos[--agenda->tamanho];
+    // Desce o ultimo evento a partir da raiz
+    size_t i = 0;
+    while (1) {
+        size_t filho = 2 * i + 1;
+        if (filho >= agenda->tamanho) break;
+        if (filho + 1 < agenda->tamanho && eventoAntesDe(&agenda->eventos[filho + 1], &agenda->eventos[filho])) filho++;
+        if (!eventoAntesDe(&agenda->eventos[filho], &ultimo)) break;
+        agenda->eventos[i] = agenda->eventos[filho];
+        i = filho;
+    }
+    if (agenda->tamanho > 0) agenda->eventos[i] = ultimo;
+    return 1;
+}
+
+// ---========= MAQUINA DE ESTADOS DO VOO =========---
+// Cada fase (POUSO, DESEMBARQUE, DECOLAGEM) pede recursos, espera numa fila se precisar, executa
+// por um tempo e devolve os recursos. Onde a thread antiga dormia ou ficava bloqueada, o voo agenda
+// um evento e devolve o worker; a continuacao roda quando o evento vence.
+
+// Ordem em que cada tipo de voo pega os recursos em cada fase
+// Indices: [fase][tipo][passo], -1 encerra a lista
+static const int ordemDeAquisicao[3][2][NUM_RECURSOS + 1] = {
+    /* POUSO */       { /* DOMESTICO */ { TORRE, PISTA, -1 },          /* INTERNACIONAL */ { PISTA, TORRE, -1 } },
+    /* DESEMBARQUE */ { /* DOMESTICO */ { TORRE, PORTAO, -1 },         /* INTERNACIONAL */ { PORTAO, TORRE, -1 } },
+    /* DECOLAGEM */   { /* DOMESTICO */ { TORRE, PORTAO, PISTA, -1 },  /* INTERNACIONAL */ { PORTAO, PISTA, TORRE, -1 } },
+};
+// Ordem em que os recursos sao devolvidos ao fim de cada fase
+static const int ordemDeLiberacao[3][NUM_RECURSOS + 1] = {
+    { PISTA, TORRE, -1 },
+    { TORRE, PORTAO, -1 },
+    { PORTAO, PISTA, TORRE, -1 },
+};
+
+static int indiceDaFase(StatusVoo status) {
+    return status == POUSANDO ? 0 : (status == DESEMBARCANDO ? 1 : 2);
+}
+
+static unsigned int conjuntoDaFase(InfoVoo *voo) {
+    const int *ordem = ordemDeAquisicao[indiceDaFase(voo->status)][voo->tipo];
+    unsigned int conjunto = 0;
+    for (int i = 0; i < NUM_RECURSOS && ordem[i] >= 0; i++) conjunto |= 1u << ordem[i];
+    return conjunto;
+}
+
+// Eventos que so interessam ao rastro binario: sem -r nem chegam ao buffer do log
+static inline void rastrear(const InfoVoo *voo, MensagemLog mensagem, int recurso) {
+    if (rastreando) registrarLog(voo, mensagem, recurso);
+}
+
+static inline Estatisticas* minhasEstatisticas() {
+    return &simulacao->fatias[indiceDoWorker].contadores;
+}
+
+// Aeroporto onde o voo esta agora (fora da rede ha um so)
+static inline Aeroporto* aeroportoDoVoo(const InfoVoo *voo) {
+    return &simulacao->aeroportos[voo->aeroporto];
+}
+
+static inline PoolDeRecurso* recursoDoVoo(const InfoVoo *voo, TipoRecurso tipo) {
+    return &aeroportoDoVoo(voo)->recursos[tipo];
+}
+
+// Toda troca de status passa por aqui, para o painel saber quantos voos ha em cada situacao
+static void mudarStatus(InfoVoo *voo, StatusVoo status) {
+    Estatisticas *contadores = minhasEstatisticas();
+    SOMAR_RELAXADO(contadores->voosPorSituacao[voo->status], -1);
+    SOMAR_RELAXADO(contadores->voosPorSituacao[status], 1);
+    voo->status = status;
+}
+
+static inline int64_t relogioRealNs() {
+    struct timespec agora;
+    clock_gettime(CLOCK_MONOTONIC, &agora);
+    return (int64_t)agora.tv_sec * NS_POR_SEGUNDO + agora.tv_nsec;
+}
+
+// Trava/destrava o mutex de um recurso do aeroporto do voo medindo a espera e o tempo de posse.
+// No modo de eventos cada aeroporto so roda numa thread por vez, entao so as aquisicoes sao contadas.
+static void travarRecurso(const InfoVoo *voo, TipoRecurso tipo) {
+    FatiaEstatisticas *fatia = &simulacao->fatias[indiceDoWorker];
+    PerfilRecurso *perfil = &fatia->contadores.perfil[tipo];
+    pthread_mutex_t *mutex = &recursoDoVoo(voo, tipo)->mutex;
+    perfil->aquisicoes++;
+    if (modoEventos) {
+        pthread_mutex_lock(mutex);
+        return;
+    }
+    if (pthread_mutex_trylock(mutex) == 0) {
+        fatia->instanteDaTrava[tipo] = relogioRealNs(); // Livre: nao houve espera
+        return;
+    }
+    int64_t antes = relogioRealNs();
+    pthread_mutex_lock(mutex);
+    int64_t depois = relogioRealNs();
+    perfil->aquisicoesDisputadas++;
+    perfil->esperaTotalNs += depois - antes;
+    if (depois - antes > perfil->esperaMaximaNs) perfil->esperaMaximaNs = depois - antes;
+    fatia->instanteDaTrava[tipo] = depois;
+}
+
+// Copia a ocupacao do recurso para os campos que o painel le (mutex do recurso travado)
+static void publicarOcupacao(Aeroporto *aeroporto, TipoRecurso tipo) {
+    PoolDeRecurso *recurso = &aeroporto->recursos[tipo];
+    GRAVAR_RELAXADO(recurso->disponivelPublicado, recurso->disponivel);
+    for (int c = 0; c < 3; c++)
+        GRAVAR_RELAXADO(recurso->esperandoPublicado[c], recurso->filas[c].tamanho + aeroporto->esperandoNoEscalonador[tipo][c]);
+}
+
+static void destravarRecurso(const InfoVoo *voo, TipoRecurso tipo) {
+    FatiaEstatisticas *fatia = &simulacao->fatias[indiceDoWorker];
+    if (!modoEventos) fatia->contadores.perfil[tipo].posseTotalNs += relogioRealNs() - fatia->instanteDaTrava[tipo];
+    if (nomeDoPainel != NULL) publicarOcupacao(aeroportoDoVoo(voo), tipo);
+    pthread_mutex_unlock(&recursoDoVoo(voo, tipo)->mutex);
+}
+
+// As funcoes de fila abaixo precisam do mutex do recurso travado
+
+// Verifica se o voo pode pegar uma unidade do recurso agora:
+// 1. Tem recurso disponivel
+// 2. E critico ou não tem críticos esperando
+// 3. E internacional/critico ou não tem internacionais na fila
+static int podePegarRecurso(InfoVoo *voo, PoolDeRecurso *recurso) {
+    return recurso->disponivel > 0 &&
+           (voo->eCritico || recurso->esperandoCritico == 0) &&
+           (voo->tipo == INTERNACIONAL || voo->eCritico || recurso->esperandoInternacional == 0);
+}
+
+static void entrarNaFila(PoolDeRecurso *recurso, InfoVoo *voo) {
+    // Define a fila de espera: critico, internacional ou domestico
+    int classe = voo->eCritico ? 0 : (voo->tipo == INTERNACIONAL ? 1 : 2);
+    FilaVoos *fila = &recurso->filas[classe];
+    voo->filaDeEspera = classe;
+    voo->proximoNaFila = NULL;
+    voo->anteriorNaFila = fila->fim;
+    if (fila->fim) fila->fim->proximoNaFila = voo; else fila->inicio = voo;
+    fila->fim = voo;
+    fila->tamanho++;
+    if (classe == 0) recurso->esperandoCritico++;
+    if (classe == 1) recurso->esperandoInternacional++;
+    rastrear(voo, MSG_ENTROU_NA_FILA, recurso - aeroportoDoVoo(voo)->recursos);
+}
+
+static void sairDaFila(PoolDeRecurso *recurso, InfoVoo *voo) {
+    FilaVoos *fila = &recurso->filas[voo->filaDeEspera];
+    if (voo->anteriorNaFila) voo->anteriorNaFila->proximoNaFila = voo->proximoNaFila; else fila->inicio = voo->proximoNaFila;
+    if (voo->proximoNaFila) voo->proximoNaFila->anteriorNaFila = voo->anteriorNaFila; else fila->fim = voo->anteriorNaFila;
+    voo->proximoNaFila = voo->anteriorNaFila = NULL;
+    fila->tamanho--;
+    if (voo->filaDeEspera == 0) recurso->esperandoCritico--;
+    if (voo->filaDeEspera == 1) recurso->esperandoInternacional--;
+    rastrear(voo, MSG_SAIU_DA_FILA, recurso - aeroportoDoVoo(voo)->recursos);
+}
+
+static void concederRecurso(PoolDeRecurso *recurso, TipoRecurso tipo, InfoVoo *voo) {
+    recurso->disponivel--;
+    voo->recursosEmPosse |= 1u << tipo;
+    voo->concessaoDoRecurso[tipo] = agoraNs();
+    SOMAR_RELAXADO(minhasEstatisticas()->concessoes, 1);
+    rastrear(voo, MSG_CONCESSAO, tipo);
+    // caso seja critico reseta status
+    voo->eCritico = 0;
+}
+
+static int64_t prazoDeFome(const InfoVoo *voo) {
+    return voo->inicioDaEspera + simulacao->config.alertaFomeSegundos * NS_POR_SEGUNDO;
+}
+
+static int64_t prazoDeQueda(const InfoVoo *voo) {
+    return voo->inicioDaEspera + simulacao->config.quedaAviaoSegundos * NS_POR_SEGUNDO;
+}
+
+// Agenda o alerta e a queda para os prazos que ainda nao venceram, se o evento daquele instante
+// ainda nao esta na agenda (na chegada, ou se os prazos mudaram). Os que ja venceram sao conferidos
+// quando o voo entra numa fila.
+static void armarPrazos(InfoVoo *voo, int64_t agora) {
+    int64_t fome = prazoDeFome(voo), queda = prazoDeQueda(voo);
+    if (fome > agora && voo->alertaAgendado != fome) {
+        voo->alertaAgendado = fome;
+        agendarEvento(fome, EV_ALERTA_FOME, voo);
+    }
+    if (queda > agora && voo->quedaAgendada != queda) {
+        voo->quedaAgendada = queda;
+        agendarEvento(queda, EV_QUEDA, voo);
+    }
+}
+
+// Coloca o voo na fila do recurso. Na politica incremental o timeout e agendado depois de soltar o mutex.
+// O alerta e a queda so valem com o voo na fila, e ja podem ter disparado com ele fora (acordado sem
+// conseguir o conjunto, no backoff): por isso os prazos sao conferidos aqui. Retorna -1 se o prazo de queda ja venceu (o voo
+// nao entra e quem chamou o derruba depois de soltar o mutex), 1 se venceu o de fome e ele entrou como
+// critico (quem chamou da o alerta), ou 0.
+static int esperarNoRecurso(InfoVoo *voo, TipoRecurso tipo) {
+    int64_t agora = agoraNs();
+    if (agora >= prazoDeQueda(voo)) return -1;
+    int virouCritico = agora >= prazoDeFome(voo) && !voo->eCritico;
+    if (virouCritico) voo->eCritico = 1;
+    armarPrazos(voo, agora);
+    voo->tentativa++;
+    entrarNaFila(recursoDoVoo(voo, tipo), voo);
+    atomic_store(&voo->esperandoRecurso, tipo);
+    return virouCritico;
+}
+
+// Trava o recurso em que o voo esta esperando. Retorna o recurso, ou -1 se o voo nao esta mais
+// na fila (quem liberou ja entregou o recurso a ele). Quem liberou so troca esperandoRecurso para -1.
+static int travarFilaDoVoo(InfoVoo *voo) {
+    int tipo = atomic_load(&voo->esperandoRecurso);
+    if (tipo < 0) return -1;
+    travarRecurso(voo, tipo);
+    if (atomic_load(&voo->esperandoRecurso) != tipo) {
+        destravarRecurso(voo, tipo);
+        return -1;
+    }
+    return tipo;
+}
+
+// Primeiro voo da classe mais prioritaria (1. Criticos; 2. Internacionais; 3. Domesticos), ou NULL
+static InfoVoo* primeiroDaFila(PoolDeRecurso *recurso) {
+    InfoVoo *primeiro = NULL;
+    for (int classe = 0; classe < 3 && primeiro == NULL; classe++) primeiro = recurso->filas[classe].inicio;
+    return primeiro;
+}
+
+// Trava os mutexes de todos os recursos do aeroporto do voo, na ordem de sempre (Pista -> Portao -> Torre)
+static void travarAeroporto(const InfoVoo *voo) {
+    for (int r = 0; r < NUM_RECURSOS; r++) travarRecurso(voo, r);
+}
+
+static void destravarAeroporto(const InfoVoo *voo) {
+    for (int r = NUM_RECURSOS - 1; r >= 0; r--) destravarRecurso(voo, r);
+}
+
+// Politica atomica: entrega o conjunto da fase a quem esta na fila, se ele cabe inteiro (todos os
+// mutexes do aeroporto travados). Como em devolverUnidade, so mexe nos campos de espera do voo.
+static int entregarConjuntoSeCouber(Aeroporto *aeroporto, InfoVoo *voo) {
+    unsigned int conjunto = conjuntoDaFase(voo);
+    for (int r = 0; r < NUM_RECURSOS; r++) {
+        if ((conjunto & (1u << r)) && !podePegarRecurso(voo, &aeroporto->recursos[r])) return 0;
+    }
+    sairDaFila(&aeroporto->recursos[atomic_load(&voo->esperandoRecurso)], voo);
+    for (int r = 0; r < NUM_RECURSOS; r++) {
+        if (!(conjunto & (1u << r))) continue;
+        aeroporto->recursos[r].disponivel--;
+        voo->recursosEmPosse |= 1u << r;
+        voo->concessaoDoRecurso[r] = agoraNs();
+        SOMAR_RELAXADO(minhasEstatisticas()->concessoes, 1);
+        rastrear(voo, MSG_CONCESSAO, r);
+    }
+    atomic_store(&voo->esperandoRecurso, -1);
+    agendarEvento(agoraNs(), EV_DESPERTAR, voo);
+    return 1;
+}
+
+// Politica atomica: devolve tudo o que o voo segura de uma vez e entrega os conjuntos que passaram a
+// caber. As filas dos recursos devolvidos sao percorridas em ordem de classe, e quem ainda esta
+// bloqueado por outro recurso do conjunto nao segura os seguintes. Ninguem recebe unidade solta.
+static void liberarConjunto(InfoVoo *voo) {
+    if (voo->recursosEmPosse == 0) return;
+    Aeroporto *aeroporto = aeroportoDoVoo(voo);
+    unsigned int devolvidos = 0;
+    travarAeroporto(voo);
+    for (int r = 0; r < NUM_RECURSOS; r++) {
+        if (!(voo->recursosEmPosse & (1u << r))) continue;
+        voo->recursosEmPosse &= ~(1u << r);
+        rastrear(voo, MSG_LIBERACAO, r);
+        if (aeroporto->recursos[r].deficit > 0) {
+            aeroporto->recursos[r].deficit--; // A unidade nao existe mais: ninguem recebe
+        } else {
+            aeroporto->recursos[r].disponivel++;
+            devolvidos |= 1u << r;
+        }
+    }
+    for (int r = 0; r < NUM_RECURSOS; r++) {
+        PoolDeRecurso *recurso = &aeroporto->recursos[r];
+        if (!(devolvidos & (1u << r))) continue;
+        for (int classe = 0; classe < 3; classe++) {
+            InfoVoo *esperando = recurso->filas[classe].inicio;
+            while (esperando != NULL && recurso->disponivel > 0) {
+                InfoVoo *seguinte = esperando->proximoNaFila;
+                entregarConjuntoSeCouber(aeroporto, esperando);
+                esperando = seguinte;
+            }
+        }
+    }
+    destravarAeroporto(voo);
+}
+
+// Politica incremental: devolve uma unidade do recurso (mutex ja travado) direto para o primeiro da
+// fila; os outros continuam dormindo na ordem em que chegaram.
+static void devolverUnidade(TipoRecurso tipo, InfoVoo *voo) {
+    PoolDeRecurso *recurso = recursoDoVoo(voo, tipo);
+    voo->recursosEmPosse &= ~(1u << tipo);
+    rastrear(voo, MSG_LIBERACAO, tipo);
+    if (recurso->deficit > 0) {
+        recurso->deficit--; // A unidade nao existe mais: ninguem recebe nem e acordado
+        return;
+    }
+    InfoVoo *proximo = primeiroDaFila(recurso);
+    if (proximo == NULL) {
+        recurso->disponivel++; // A unidade volta a ficar livre
+        return;
+    }
+    // Quem esta na fila nao roda ate ser acordado, entao da pra mexer no estado dele aqui
+    sairDaFila(recurso, proximo);
+    proximo->recursosEmPosse |= 1u << tipo;
+    proximo->concessaoDoRecurso[tipo] = agoraNs();
+    SOMAR_RELAXADO(minhasEstatisticas()->concessoes, 1);
+    rastrear(proximo, MSG_CONCESSAO, tipo);
+    atomic_store(&proximo->esperandoRecurso, -1);
+    agendarEvento(agoraNs(), EV_DESPERTAR, proximo);
+}
+
+void liberarRecurso(TipoRecurso tipo, InfoVoo *voo) {
+    travarRecurso(voo, tipo);
+    devolverUnidade(tipo, voo);
+    destravarRecurso(voo, tipo);
+}
+
+// ---- Escalonador central (-p prazo) ----
+// Os voos nao disputam os recursos: cada pedido entra numa lista do aeroporto ordenada pelo prazo de
+// queda (antecipado para criticos e internacionais). A cada ponto de decisao (pedido novo, recursos
+// devolvidos, voo que virou critico) o escalonador percorre a lista inteira e entrega os conjuntos
+// completos que cabem, varios de uma vez. O primeiro pedido critico que nao cabe reserva uma unidade de
+// cada recurso do conjunto que ainda tem livre, as que ele vai usar; o resto continua para os pedidos de
+// prazo maior. Os outros criticos, e os que nao sao criticos, deixam os seguintes passarem.
+
+// Insere na ordem de prioridade; empate vai para o fim. Quase sempre o pedido novo e o de prazo maior,
+// entao a busca comeca do fim.
+static void inserirPendente(Aeroporto *aeroporto, InfoVoo *voo, TipoRecurso bloqueio) {
+    FilaVoos *pendentes = &aeroporto->pendentes;
+    int64_t prazo = voo->inicioDaEspera + simulacao->config.quedaAviaoSegundos * NS_POR_SEGUNDO;
+    voo->prioridade = prazo - (voo->eCritico ? VANTAGEM_CRITICO_SEGUNDOS * NS_POR_SEGUNDO :
+                               voo->tipo == INTERNACIONAL ? VANTAGEM_INTERNACIONAL_SEGUNDOS * NS_POR_SEGUNDO : 0);
+    InfoVoo *anterior = pendentes->fim;
+    while (anterior != NULL && anterior->prioridade > voo->prioridade) anterior = anterior->anteriorNaFila;
+    voo->anteriorNaFila = anterior;
+    voo->proximoNaFila = anterior ? anterior->proximoNaFila : pendentes->inicio;
+    if (voo->proximoNaFila) voo->proximoNaFila->anteriorNaFila = voo; else pendentes->fim = voo;
+    if (anterior) anterior->proximoNaFila = voo; else pendentes->inicio = voo;
+    pendentes->tamanho++;
+    voo->filaDeEspera = voo->eCritico ? 0 : (voo->tipo == INTERNACIONAL ? 1 : 2);
+    aeroporto->esperandoNoEscalonador[bloqueio][voo->filaDeEspera]++;
+    atomic_store(&voo->esperandoRecurso, bloqueio);
+    rastrear(voo, MSG_ENTROU_NA_FILA, bloqueio);
+}
+
+static void removerPendente(Aeroporto *aeroporto, InfoVoo *voo) {
+    FilaVoos *pendentes = &aeroporto->pendentes;
+    int bloqueio = atomic_load(&voo->esperandoRecurso);
+    if (voo->anteriorNaFila) voo->anteriorNaFila->proximoNaFila = voo->proximoNaFila; else pendentes->inicio = voo->proximoNaFila;
+    if (voo->proximoNaFila) voo->proximoNaFila->anteriorNaFila = voo->anteriorNaFila; else pendentes->fim = voo->anteriorNaFila;
+    voo->proximoNaFila = voo->anteriorNaFila = NULL;
+    pendentes->tamanho--;
+    aeroporto->esperandoNoEscalonador[bloqueio][voo->filaDeEspera]--;
+    atomic_store(&voo->esperandoRecurso, -1);
+    rastrear(voo, MSG_SAIU_DA_FILA, bloqueio);
+}
+
+// Entrega os conjuntos que cabem, em ordem de prioridade (todos os mutexes do aeroporto travados).
+// Quem recebe e acordado, menos quemPediu, que continua direto. Devolve quantos pedidos foram atendidos.
+// Como em devolverUnidade, so mexe nos campos de espera do voo: o worker dele pode estar rodando o alerta.
+static int despachar(Aeroporto *aeroporto, InfoVoo *quemPediu) {
+    int livres[NUM_RECURSOS], atendidos = 0, algumLivre = 0, reservou = 0;
+    for (int r = 0; r < NUM_RECURSOS; r++) {
+        livres[r] = aeroporto->recursos[r].disponivel;
+        algumLivre |= livres[r] > 0;
+    }
+    InfoVoo *voo = aeroporto->pendentes.inicio;
+    while (voo != NULL && algumLivre) {
+        InfoVoo *seguinte = voo->proximoNaFila;
+        unsigned int conjunto = conjuntoDaFase(voo);
+        int cabe = 1;
+        for (int r = 0; r < NUM_RECURSOS; r++) {
+            if ((conjunto & (1u << r)) && livres[r] <= 0) cabe = 0;
+        }
+        if (cabe) {
+            removerPendente(aeroporto, voo);
+            for (int r = 0; r < NUM_RECURSOS; r++) {
+                if (conjunto & (1u << r)) {
+                    livres[r]--;
+                    aeroporto->recursos[r].disponivel--;
+                    voo->recursosEmPosse |= 1u << r;
+                    voo->concessaoDoRecurso[r] = agoraNs();
+                    SOMAR_RELAXADO(minhasEstatisticas()->concessoes, 1);
+                    rastrear(voo, MSG_CONCESSAO, r);
+                }
+            }
+            atendidos++;
+            if (voo != quemPediu) agendarEvento(agoraNs(), EV_DESPERTAR, voo);
+        } else if (voo->eCritico && !reservou) {
+            reservou = 1;
+            for (int r = 0; r < NUM_RECURSOS; r++) {
+                if ((conjunto & (1u << r)) && livres[r] > 0) livres[r]--;
+            }
+        }
+        algumLivre = 0;
+        for (int r = 0; r < NUM_RECURSOS; r++) algumLivre |= livres[r] > 0;
+        voo = seguinte;
+    }
+    return atendidos;
+}
+
+// Devolve tudo o que o voo segura e decide quem recebe, numa passada so
+static void liberarNoEscalonador(InfoVoo *voo) {
+    if (voo->recursosEmPosse == 0) return;
+    Aeroporto *aeroporto = aeroportoDoVoo(voo);
+    travarAeroporto(voo);
+    for (int r = 0; r < NUM_RECURSOS; r++) {
+        if (voo->recursosEmPosse & (1u << r)) {
+            voo->recursosEmPosse &= ~(1u << r);
+            if (aeroporto->recursos[r].deficit > 0) aeroporto->recursos[r].deficit--;
+            else aeroporto->recursos[r].disponivel++;
+            rastrear(voo, MSG_LIBERACAO, r);
+        }
+    }
+    despachar(aeroporto, NULL);
+    destravarAeroporto(voo);
+}
+
+static void liberarTodosOsRecursos(InfoVoo *voo, const int ordem[NUM_RECURSOS + 1]) {
+    if (simulacao->config.politica == POLITICA_PRAZO) {
+        liberarNoEscalonador(voo);
+        return;
+    }
+    if (simulacao->config.politica == POLITICA_ATOMICA) {
+        liberarConjunto(voo);
+        return;
+    }
+    for (int i = 0; i < NUM_RECURSOS && ordem[i] >= 0; i++) {
+        if (voo->recursosEmPosse & (1u << ordem[i])) liberarRecurso(ordem[i], voo);
+    }
+}
+
+static void encerrarWorkers() {
+    atomic_store(&simulacao->simulacaoEncerrada, 1);
+    for (int i = 0; i < simulacao->numeroDeWorkers; i++) {
+        pthread_mutex_lock(&simulacao->agendas[i].mutex);
+        pthread_cond_broadcast(&simulacao->agendas[i].cond);
+        pthread_mutex_unlock(&simulacao->agendas[i].mutex);
+    }
+}
+
+// Chamado quando o voo termina (concluido ou acidente)
+static void finalizarVoo(InfoVoo *voo) {
+    atualizarResumoDoVoo(voo);
+    // Os prazos que sobram na agenda ainda avancam o relogio depois do ultimo voo: a duracao vem daqui.
+    // Na rede cada aeroporto tem o seu relogio, entao o worker guarda o maior.
+    Estatisticas *contadores = minhasEstatisticas();
+    if (agoraNs() > contadores->duracaoTotalNs) contadores->duracaoTotalNs = agoraNs();
+    if (atomic_fetch_sub(&simulacao->voosEmAndamento, 1) == 1 && atomic_load(&simulacao->chegadasEncerradas)) encerrarWorkers();
+}
+
+static void derrubarAviao(InfoVoo *voo) {
+    mudarStatus(voo, ACIDENTE);
+    voo->eCritico = 0;
+    SOMAR_RELAXADO(minhasEstatisticas()->voosAcidentados, 1);
+    logEvento(voo, MSG_QUEDA);
+    // Devolve o que estava segurando (so acontece na politica incremental)
+    liberarTodosOsRecursos(voo, ordemDeLiberacao[2]);
+    finalizarVoo(voo);
+}
+
+static void alertarFome(InfoVoo *voo) {
+    logEvento(voo, MSG_MAYDAY);
+    SOMAR_RELAXADO(minhasEstatisticas()->alertasDeStarvation, 1);
+}
+
+// Marca o primeiro pedido de cada recurso na fase; as novas tentativas nao reiniciam a espera
+static void marcarPedido(InfoVoo *voo, unsigned int conjunto) {
+    unsigned int novos = conjunto & ~voo->recursosPedidos;
+    if (novos == 0) return;
+    int64_t agora = agoraNs();
+    for (int r = 0; r < NUM_RECURSOS; r++) {
+        if (novos & (1u << r)) voo->pedidoDoRecurso[r] = agora;
+    }
+    voo->recursosPedidos |= novos;
+}
+
+static void executarFase(InfoVoo *voo) {
+    // Conseguiu todos os recursos da fase
+    voo->eCritico = 0;
+    voo->inicioDoServico = agoraNs();
+    registrarEspera(voo, voo->inicioDoServico);
+    rastrear(voo, MSG_INICIO_DA_FASE, -1);
+    unsigned int duracao;
+    if (voo->status == POUSANDO) {
+        duracao = DURACAO_POUSO; // Precisa de torre e pista
+    } else if (voo->status == DESEMBARCANDO) {
+        logEvento(voo, MSG_DESEMBARCANDO);
+        duracao = DURACAO_DESEMBARQUE; // precisa de portao e torre
+    } else {
+        duracao = DURACAO_DECOLAGEM; // Precisa dos tres
+    }
+    agendarEvento(agoraNs() + duracao * NS_POR_SEGUNDO, EV_FIM_FASE, voo);
+}
+
+static void solicitarConjunto(InfoVoo *voo) {
+    unsigned int conjunto = conjuntoDaFase(voo);
+    if ((conjunto & ~voo->recursosEmPosse) == 0) {
+        executarFase(voo); // Acordou com o conjunto ja entregue por liberarConjunto
+        return;
+    }
+    marcarPedido(voo, conjunto);
+    // Trava os mutexes sempre na mesma ordem (Pista -> Portao -> Torre), entao nao ha espera circular
+    for (int r = 0; r < NUM_RECURSOS; r++) {
+        if (conjunto & (1u << r)) travarRecurso(voo, r);
+    }
+    // Procura o primeiro recurso do conjunto que impede a concessao
+    int bloqueio = -1, espera = 0;
+    for (int r = 0; r < NUM_RECURSOS && bloqueio < 0; r++) {
+        if ((conjunto & (1u << r)) && !podePegarRecurso(voo, recursoDoVoo(voo, r))) bloqueio = r;
+    }
+    if (bloqueio < 0) {
+        // Todos livres: pega tudo de uma vez
+        for (int r = 0; r < NUM_RECURSOS; r++) {
+            if (conjunto & (1u << r)) concederRecurso(recursoDoVoo(voo, r), r, voo);
+        }
+    } else {
+        // Espera no recurso que faltou sem segurar nenhuma unidade
+        espera = esperarNoRecurso(voo, bloqueio);
+    }
+    for (int r = NUM_RECURSOS - 1; r >= 0; r--) {
+        if (conjunto & (1u << r)) destravarRecurso(voo, r);
+    }
+    // Se esperou, so volta quando alguem o acordar (ou no prazo de fome/queda)
+    if (bloqueio < 0) executarFase(voo);
+    else if (espera < 0) derrubarAviao(voo);
+    else if (espera > 0) alertarFome(voo);
+}
+
+// Pede o conjunto da fase ao escalonador. Se ja recebeu (acordou com EV_DESPERTAR) ou se ha lugar
+// agora, executa a fase; senao espera na lista ate o escalonador entregar ou o prazo de queda vencer.
+static void pedirAoEscalonador(InfoVoo *voo) {
+    unsigned int conjunto = conjuntoDaFase(voo);
+    if ((conjunto & ~voo->recursosEmPosse) == 0) {
+        executarFase(voo);
+        return;
+    }
+    Aeroporto *aeroporto = aeroportoDoVoo(voo);
+    marcarPedido(voo, conjunto);
+    travarAeroporto(voo);
+    // Conta o pedido no primeiro recurso do conjunto que esta em falta
+    int bloqueio = -1;
+    for (int r = 0; r < NUM_RECURSOS && bloqueio < 0; r++) {
+        if ((conjunto & (1u << r)) && aeroporto->recursos[r].disponivel <= 0) bloqueio = r;
+    }
+    if (bloqueio < 0) bloqueio = __builtin_ctz(conjunto);
+    inserirPendente(aeroporto, voo, bloqueio);
+    despachar(aeroporto, voo);
+    // Depois de destravar, outro worker pode entregar o conjunto e acordar o voo: so decide aqui dentro
+    int atendido = (conjunto & ~voo->recursosEmPosse) == 0, caiu = 0, alertou = 0;
+    if (!atendido) {
+        // Como em esperarNoRecurso: o alerta e a queda podem ter disparado com o voo fora da lista. Sem
+        // conferir, ele ficaria na lista sem prazo e, com a prioridade ja vencida, na frente de todos.
+        int64_t agora = agoraNs();
+        if (agora >= prazoDeQueda(voo)) {
+            removerPendente(aeroporto, voo);
+            caiu = 1;
+        } else {
+            if (agora >= prazoDeFome(voo) && !voo->eCritico) {
+                removerPendente(aeroporto, voo);
+                voo->eCritico = 1;
+                inserirPendente(aeroporto, voo, bloqueio);
+                despachar(aeroporto, NULL);
+                alertou = 1;
+            }
+            armarPrazos(voo, agora);
+        }
+    }
+    destravarAeroporto(voo);
+    if (atendido) executarFase(voo);
+    if (caiu) derrubarAviao(voo);
+    if (alertou) alertarFome(voo);
+}
+
+// EV_ALERTA_FOME no escalonador: o voo que ainda espera passa a critico e sobe na lista
+static void alertarNoEscalonador(InfoVoo *voo) {
+    Aeroporto *aeroporto = aeroportoDoVoo(voo);
+    travarAeroporto(voo);
+    int bloqueio = atomic_load(&voo->esperandoRecurso);
+    int alertou = bloqueio >= 0 && !voo->eCritico;
+    if (alertou) {
+        removerPendente(aeroporto, voo);
+        voo->eCritico = 1;
+        inserirPendente(aeroporto, voo, bloqueio);
+        despachar(aeroporto, NULL);
+    }
+    destravarAeroporto(voo);
+    if (alertou) alertarFome(voo);
+}
+
+// EV_QUEDA no escalonador: cai se o conjunto ainda nao foi entregue
+static void derrubarNoEscalonador(InfoVoo *voo) {
+    travarAeroporto(voo);
+    int esperando = atomic_load(&voo->esperandoRecurso) >= 0;
+    if (esperando) removerPendente(aeroportoDoVoo(voo), voo);
+    destravarAeroporto(voo);
+    if (esperando) derrubarAviao(voo);
+}
+
+static void solicitarProximoRecurso(InfoVoo *voo) {
+    if (simulacao->config.politica == POLITICA_PRAZO) {
+        pedirAoEscalonador(voo);
+        return;
+    }
+    if (simulacao->config.politica == POLITICA_ATOMICA) {
+        // Pede o conjunto inteiro da fase: ou pega tudo ou espera sem segurar nada
+        solicitarConjunto(voo);
+        return;
+    }
+    const int *ordem = ordemDeAquisicao[indiceDaFase(voo->status)][voo->tipo];
+    while (voo->passo < NUM_RECURSOS && ordem[voo->passo] >= 0) {
+        TipoRecurso tipo = ordem[voo->passo];
+        PoolDeRecurso *recurso = recursoDoVoo(voo, tipo);
+        if (voo->recursosEmPosse & (1u << tipo)) {
+            // Entregue enquanto esperava na fila
+            voo->passo++;
+            continue;
+        }
+        marcarPedido(voo, 1u << tipo);
+        travarRecurso(voo, tipo);
+        if (podePegarRecurso(voo, recurso)) {
+            concederRecurso(recurso, tipo, voo);
+            destravarRecurso(voo, tipo);
+            voo->passo++;
+            continue;
+        }
+        // Nao conseguiu: entra na fila e marca o fim da tentativa
+        int espera = esperarNoRecurso(voo, tipo);
+        destravarRecurso(voo, tipo);
+        if (espera < 0) {
+            derrubarAviao(voo);
+            return;
+        }
+        if (espera > 0) alertarFome(voo);
+        agendarEvento(agoraNs() + TIMEOUT_TENTATIVA_SEGUNDOS * NS_POR_SEGUNDO, EV_TIMEOUT, voo);
+        return;
+    }
+    executarFase(voo);
+}
+
+static void iniciarFase(InfoVoo *voo, StatusVoo fase) {
+    mudarStatus(voo, fase);
+    voo->passo = 0;
+    voo->recursosPedidos = 0;
+    voo->inicioDaFase = agoraNs();
+    // A espera de cada fase conta do pedido dela: os prazos da fase anterior ficam sem efeito
+    voo->inicioDaEspera = voo->inicioDaFase;
+    armarPrazos(voo, voo->inicioDaEspera);
+    rastrear(voo, MSG_PEDIDO_DA_FASE, -1);
+    if (fase == POUSANDO) logEvento(voo, MSG_INICIO_POUSO);
+    if (fase == DECOLANDO) logEvento(voo, MSG_INICIO_DECOLAGEM);
+    solicitarProximoRecurso(voo);
+}
+
+static void terminarTentativa(InfoVoo *voo, unsigned int tentativa) {
+    int tipo = travarFilaDoVoo(voo);
+    if (tipo < 0) return; // Ja foi acordado; o EV_DESPERTAR continua daqui
+    PoolDeRecurso *recurso = recursoDoVoo(voo, tipo);
+    if (voo->tentativa != tentativa) { destravarRecurso(voo, tipo); return; }
+    SOMAR_RELAXADO(minhasEstatisticas()->despertares, 1); // Acordou pelo timeout ainda na fila
+    int64_t esperaTotal = agoraNs() - voo->inicioDaEspera;
+    sairDaFila(recurso, voo);
+    atomic_store(&voo->esperandoRecurso, -1);
+    // Se passou do tempo de queda, então caiu
+    if (esperaTotal >= simulacao->config.quedaAviaoSegundos * NS_POR_SEGUNDO) {
+        destravarRecurso(voo, tipo);
+        derrubarAviao(voo);
+        return;
+    }
+    // Se esperou demais, vai para crítico
+    int virouCritico = esperaTotal >= simulacao->config.alertaFomeSegundos * NS_POR_SEGUNDO && !voo->eCritico;
+    if (virouCritico) voo->eCritico = 1;
+    destravarRecurso(voo, tipo);
+    if (virouCritico) alertarFome(voo);
+
+    // So a politica incremental tem timeout: ela segura recursos enquanto espera
+    if (voo->recursosEmPosse && voo->status != DECOLANDO) {
+        registrarLog(voo, MSG_TIMEOUT, tipo);
+    }
+    if (voo->recursosEmPosse) {
+        // Devolver o que segura em vez de esperar segurando e o que evita o deadlock
+        Estatisticas *contadores = minhasEstatisticas();
+        SOMAR_RELAXADO(contadores->deadlocksEvitados, 1);
+        for (int r = 0; r < NUM_RECURSOS; r++) {
+            if (voo->recursosEmPosse & (1u << r)) contadores->perfil[r].liberacoesPorBackoff++;
+        }
+    }
+    liberarTodosOsRecursos(voo, ordemDeLiberacao[2]);
+    voo->passo = 0;
+    // Espera aleatoriamente entre as tentativas
+    agendarEvento(agoraNs() + (proximoAleatorio(&voo->gerador) % 3 + 1) * NS_POR_SEGUNDO, EV_NOVA_TENTATIVA, voo);
+}
+
+// Entrega o voo ao aeroporto de destino para pousar no instante chegada. Em tempo real o evento vai
+// direto para a agenda do worker dono do destino. No modo de eventos o destino pode estar rodando em
+// outra thread nesta janela, entao o voo entra na caixa de entrada dele e so vira evento entre janelas.
+static void enviarVoo(InfoVoo *voo, int destino, int64_t chegada) {
+    voo->aeroporto = destino;
+    if (!modoEventos) {
+        agendarEvento(chegada, EV_CHEGADA, voo);
+        return;
+    }
+    Aeroporto *aeroporto = &simulacao->aeroportos[destino];
+    voo->chegadaPrevista = chegada;
+    InfoVoo *topo = atomic_load_explicit(&aeroporto->caixaDeEntrada, memory_order_relaxed);
+    do {
+        voo->proximoNaFila = topo;
+    } while (!atomic_compare_exchange_weak_explicit(&aeroporto->caixaDeEntrada, &topo, voo,
+                                                    memory_order_release, memory_order_relaxed));
+}
+
+// Na rede, o voo que decolou segue para outro aeroporto e volta a aguardar, agora no ar.
+// O trecho novo invalida os eventos que sobraram do anterior (alerta e queda na agenda antiga).
+static void voarParaOutroAeroporto(InfoVoo *voo) {
+    int numero = simulacao->config.numeroDeAeroportos;
+    int destino = (voo->aeroporto + 1 + proximoAleatorio(&voo->gerador) % (numero - 1)) % numero;
+    int64_t duracao = TEMPO_DE_VOO_MINIMO * NS_POR_SEGUNDO +
+        (int64_t)(aleatorioUniforme(&voo->gerador) * (TEMPO_DE_VOO_MAXIMO - TEMPO_DE_VOO_MINIMO) * NS_POR_SEGUNDO);
+    voo->trechosRestantes--;
+    minhasEstatisticas()->trechosVoados++;
+    mudarStatus(voo, AGUARDANDO);
+    atomic_fetch_add_explicit(&voo->trecho, 1, memory_order_relaxed);
+    enviarVoo(voo, destino, agoraNs() + duracao);
+}
+
+static void terminarFase(InfoVoo *voo) {
+    int fase = indiceDaFase(voo->status);
+    rastrear(voo, MSG_FIM_DA_FASE, -1);
+    if (voo->status == POUSANDO) logEvento(voo, MSG_POUSO_CONCLUIDO);
+    if (voo->status == DECOLANDO) logEvento(voo, MSG_DECOLAGEM_CONCLUIDA);
+    if (voo->status != DESEMBARCANDO) registrarLatencia(voo->status, voo->inicioDaFase);
+    registrarServico(voo, conjuntoDaFase(voo), agoraNs());
+    liberarTodosOsRecursos(voo, ordemDeLiberacao[fase]);
+    if (voo->status == POUSANDO) {
+        iniciarFase(voo, DESEMBARCANDO);
+    } else if (voo->status == DESEMBARCANDO) {
+        iniciarFase(voo, DECOLANDO);
+    } else if (voo->trechosRestantes > 0) {
+        voarParaOutroAeroporto(voo);
+    } else {
+        mudarStatus(voo, CONCLUIDO); // Define o status do voo para CONCLUIDO
+        rastrear(voo, MSG_CONCLUIDO, -1);
+        SOMAR_RELAXADO(minhasEstatisticas()->voosSucesso, 1);
+        finalizarVoo(voo);
+    }
+}
+
+// Cria o proximo voo. Sem registro (chegadas sinteticas) o tipo e sorteado e o codigo e o id.
+static void criarProximoVoo(const RegistroDeChegada *registro) {
+    InfoVoo *info = alocarVoo(simulacao->totalDeVoosCriados);
+    info->id = simulacao->totalDeVoosCriados + 1;
+    semearGerador(&info->gerador, simulacao->config.semente, info->id);
+    if (registro != NULL) {
+        info->codigo = registro->codigo;
+        info->tipo = registro->tipo;
+        info->eCritico = registro->critico; // Ja entra na fila de criticos para pousar
+    } else {
+        info->codigo = info->id;
+        info->tipo = aleatorioUniforme(&info->gerador) < simulacao->config.fracaoInternacional ? INTERNACIONAL : DOMESTICO;
+    }
+    if (simulacao->config.numeroDeAeroportos > 1) {
+        // Na rede o primeiro pouso e num aeroporto sorteado, e o voo ainda voa os outros trechos
+        info->aeroporto = proximoAleatorio(&info->gerador) % simulacao->config.numeroDeAeroportos;
+        info->trechosRestantes = simulacao->config.trechosPorVoo - 1;
+    }
+    info->status = AGUARDANDO;
+    SOMAR_RELAXADO(minhasEstatisticas()->voosPorSituacao[AGUARDANDO], 1);
+    atomic_init(&info->esperandoRecurso, -1);
+    info->alertaAgendado = info->quedaAgendada = -1;
+    atualizarResumoDoVoo(info);
+    SOMAR_RELAXADO(simulacao->totalDeVoosCriados, 1);
+    int ativos = atomic_fetch_add(&simulacao->voosEmAndamento, 1) + 1;
+    if (ativos > minhasEstatisticas()->picoDeVoosAtivos) minhasEstatisticas()->picoDeVoosAtivos = ativos;
+    // O voo comeca no worker dele
+    agendarEvento(agoraNs(), EV_CHEGADA, info);
+}
+
+// Encerra as chegadas; se nao ha voo no ar, a simulacao acaba aqui
+static void encerrarChegadas() {
+    atomic_store(&simulacao->chegadasEncerradas, 1);
+    if (atomic_load(&simulacao->voosEmAndamento) == 0) encerrarWorkers();
+}
+
+// Cria os voos do arquivo cujo instante ja chegou e agenda a proxima chegada registrada.
+// So um registro fica fora do arquivo por vez, entao a memoria nao depende do tamanho do arquivo.
+static void liberarChegadasDoArquivo() {
+    while (simulacao->haProximaChegada && simulacao->proximaChegada.instanteNs <= agoraNs()) {
+        criarProximoVoo(&simulacao->proximaChegada);
+        simulacao->haProximaChegada = lerProximaChegada(&simulacao->chegadas, &simulacao->proximaChegada);
+    }
+    if (simulacao->haProximaChegada &&
+        simulacao->proximaChegada.instanteNs < (int64_t)simulacao->config.duracaoSegundos * NS_POR_SEGUNDO) {
+        agendarEvento(simulacao->proximaChegada.instanteNs, EV_PROXIMA_CHEGADA, NULL);
+    } else {
+        encerrarChegadas();
+    }
+}
+
+// Conta o fim de um evento do voo. Depois do ultimo evento de um voo terminado nada mais aponta
+// para o InfoVoo, e ele volta para a reserva. Voo terminado nao esta em fila nenhuma, entao
+// ninguem agenda evento novo para ele.
+static void encerrarEventoDoVoo(InfoVoo *voo) {
+    if (atomic_fetch_sub(&voo->eventosPendentes, 1) == 1 &&
+        (voo->status == CONCLUIDO || voo->status == ACIDENTE)) {
+        devolverVoo(voo);
+    }
+}
+
+// EV_PROXIMA_CHEGADA: um voo novo a cada intervalo enquanto houver tempo de simulacao
+static void processarProximaChegada() {
+    if (simulacao->config.arquivoDeChegadas != NULL) {
+        liberarChegadasDoArquivo();
+        return;
+    }
+    criarProximoVoo(NULL);
+    int64_t intervalo = simulacao->config.intervaloChegadasNs;
+    if (simulacao->config.variacaoChegadas > 0) {
+        intervalo += (int64_t)(intervalo * simulacao->config.variacaoChegadas *
+                               (2 * aleatorioUniforme(&simulacao->geradorDeChegadas) - 1));
+        if (intervalo < 1) intervalo = 1;
+    }
+    if (agoraNs() + intervalo < (int64_t)simulacao->config.duracaoSegundos * NS_POR_SEGUNDO) {
+        agendarEvento(agoraNs() + intervalo, EV_PROXIMA_CHEGADA, NULL);
+    } else {
+        encerrarChegadas();
+    }
+}
+
+void processarEvento(const Evento *evento) {
+    InfoVoo *voo = evento->voo;
+    if (voo == NULL) { // So EV_PROXIMA_CHEGADA nao pertence a um voo
+        processarProximaChegada();
+        return;
+    }
+    // Voo que ja terminou ignora os eventos que sobraram (alerta, queda). Na rede, os que sobraram de
+    // um trecho anterior podem estar na agenda de outro aeroporto: so o trecho (atomico) e lido.
+    if (evento->trecho != atomic_load_explicit(&voo->trecho, memory_order_relaxed) ||
+        voo->status == CONCLUIDO || voo->status == ACIDENTE) {
+        encerrarEventoDoVoo(voo);
+        return;
+    }
+    int tipo;
+    switch (evento->tipo) {
+        case EV_PROXIMA_CHEGADA:
+            break;
+        case EV_CHEGADA:
+            rastrear(voo, MSG_CHEGADA, -1);
+            iniciarFase(voo, POUSANDO);
+            break;
+        case EV_DESPERTAR:
+            SOMAR_RELAXADO(minhasEstatisticas()->despertares, 1);
+            solicitarProximoRecurso(voo);
+            break;
+        case EV_NOVA_TENTATIVA:
+            solicitarProximoRecurso(voo);
+            break;
+        case EV_FIM_FASE:
+            terminarFase(voo);
+            break;
+        case EV_TIMEOUT:
+            terminarTentativa(voo, evento->tentativa);
+            break;
+        case EV_ALERTA_FOME:
+            if (evento->instante != voo->alertaAgendado) break; // Prazo antigo, ja reagendado
+            if (simulacao->config.politica == POLITICA_PRAZO) { alertarNoEscalonador(voo); break; }
+            // So vale se o voo esta numa fila agora: passa para a fila de criticos do mesmo recurso
+            tipo = travarFilaDoVoo(voo);
+            if (tipo < 0) break;
+            if (voo->eCritico) { destravarRecurso(voo, tipo); break; }
+            sairDaFila(recursoDoVoo(voo, tipo), voo);
+            voo->eCritico = 1;
+            entrarNaFila(recursoDoVoo(voo, tipo), voo);
+            destravarRecurso(voo, tipo);
+            alertarFome(voo);
+            break;
+        case EV_QUEDA:
+            // Cai se ainda estiver esperando quando o prazo vence
+            if (evento->instante != voo->quedaAgendada) break;
+            if (simulacao->config.politica == POLITICA_PRAZO) { derrubarNoEscalonador(voo); break; }
+            tipo = travarFilaDoVoo(voo);
+            if (tipo < 0) break;
+            sairDaFila(recursoDoVoo(voo, tipo), voo);
+            atomic_store(&voo->esperandoRecurso, -1);
+            destravarRecurso(voo, tipo);
+            derrubarAviao(voo);
+            break;
+    }
+    encerrarEventoDoVoo(voo);
+}
+
+// ---========= SIMULACAO EM TEMPO REAL (POOL DE WORKERS) =========---
+// Cada worker dorme ate o instante do primeiro evento da sua agenda e entao o processa.
+// Nao ha uma thread por voo: milhares de voos esperando custam so a memoria do InfoVoo e dos eventos.
+
+static void* executarWorker(void *arg) {
+    FilaDeEventos *agenda = (FilaDeEventos*)arg;
+    simulacao = agenda->simulacao;
+    indiceDoWorker = agenda - simulacao->agendas; // Conta as estatisticas na fatia deste worker
+    pthread_mutex_lock(&agenda->mutex);
+    while (!atomic_load(&simulacao->simulacaoEncerrada)) {
+        if (agenda->tamanho == 0) {
+            pthread_cond_wait(&agenda->cond, &agenda->mutex);
+            continue;
+        }
+        int64_t instante = agenda->eventos[0].instante;
+        if (instante > agoraNs()) {
+            // Dorme ate o evento vencer (ou ate chegar um evento mais cedo)
+            struct timespec prazo;
+            int64_t absoluto = simulacao->inicioRealNs + instante;
+            prazo.tv_sec = absoluto / NS_POR_SEGUNDO;
+            prazo.tv_nsec = absoluto % NS_POR_SEGUNDO;
+            pthread_cond_timedwait(&agenda->cond, &agenda->mutex, &prazo);
+            continue;
+        }
+        Evento evento;
+        retirarEvento(agenda, &evento);
+        pthread_mutex_unlock(&agenda->mutex);
+        processarEvento(&evento);
+        pthread_mutex_lock(&agenda->mutex);
+    }
+    pthread_mutex_unlock(&agenda->mutex);
+    return NULL;
+}
+
+void executarSimulacaoTempoReal() {
+    pthread_t *workers = malloc(simulacao->numeroDeWorkers * sizeof(pthread_t));
+    GRAVAR_RELAXADO(simulacao->inicioRealNs, 0); // agoraNs() passa a contar a partir daqui
+    GRAVAR_RELAXADO(simulacao->inicioRealNs, agoraNs());
+    agendarEvento(0, EV_PROXIMA_CHEGADA, NULL);
+    for (int i = 0; i < simulacao->numeroDeWorkers; i++) {
+        pthread_create(&workers[i], NULL, executarWorker, &simulacao->agendas[i]);
+    }
+    // A thread principal so espera o tempo de simulacao acabar
+    sleep(simulacao->config.duracaoSegundos);
+    registrarLog(NULL, MSG_TEMPO_ESGOTADO, -1); // Pelo log, para sair na ordem certa
+    for (int i = 0; i < simulacao->numeroDeWorkers; i++) {
+        pthread_join(workers[i], NULL);
+    }
+    finalizarLog();
+    free(workers);
+}
+
+// ---========= REDE DE AEROPORTOS POR EVENTOS DISCRETOS =========---
+// Cada aeroporto e um processo logico com agenda, relogio e recursos proprios. Um voo so passa de um
+// aeroporto para outro decolando, e pousa no minimo TEMPO_DE_VOO_MINIMO depois. Entao, se o evento
+// mais cedo da rede esta em T, todos os eventos antes de T + TEMPO_DE_VOO_MINIMO podem rodar sem que
+// nenhum aeroporto receba voo novo nesse intervalo (janela conservadora, sem rollback).
+// Em cada janela o coordenador (a thread principal) entrega os voos em transito, cria os voos que
+// chegam na janela e divide os aeroportos com eventos entre os workers pelo dono (aeroporto % workers).
+// Quem termina os seus rouba os que sobraram na lista dos outros. O resultado nao depende de quantos
+// workers ha nem de quem roubou o que; so o log sai aeroporto por aeroporto dentro de cada janela.
+
+// Pousa antes quem chega antes; no mesmo instante, o voo de menor id. Assim a agenda do destino
+// recebe os voos na mesma ordem qualquer que seja a thread que empilhou cada um.
+static int chegaAntes(const InfoVoo *a, const InfoVoo *b) {
+    if (a->chegadaPrevista != b->chegadaPrevista) return a->chegadaPrevista < b->chegadaPrevista;
+    return a->id < b->id;
+}
+
+// Esvazia a caixa de entrada do aeroporto e agenda o pouso de cada voo. So entre janelas.
+static void receberVoosEmTransito(Aeroporto *aeroporto) {
+    InfoVoo *pilha = atomic_exchange_explicit(&aeroporto->caixaDeEntrada, NULL, memory_order_acquire);
+    InfoVoo *ordenados = NULL;
+    while (pilha != NULL) {
+        InfoVoo *voo = pilha, **posicao = &ordenados;
+        pilha = pilha->proximoNaFila;
+        while (*posicao != NULL && chegaAntes(*posicao, voo)) posicao = &(*posicao)->proximoNaFila;
+        voo->proximoNaFila = *posicao;
+        *posicao = voo;
+    }
+    while (ordenados != NULL) {
+        InfoVoo *voo = ordenados;
+        ordenados = ordenados->proximoNaFila;
+        voo->proximoNaFila = NULL;
+        agendarEvento(voo->chegadaPrevista, EV_CHEGADA, voo);
+    }
+}
+
+// Roda os eventos do aeroporto ate o horizonte. Na janela so esta thread mexe na agenda dele.
+static void processarAeroporto(Aeroporto *aeroporto, int64_t horizonte) {
+    FilaDeEventos *agenda = &aeroporto->agenda;
+    relogioVirtual = &aeroporto->relogioNs;
+    Evento evento;
+    while (agenda->tamanho > 0 && agenda->eventos[0].instante < horizonte) {
+        retirarEvento(agenda, &evento);
+        GRAVAR_RELAXADO(aeroporto->relogioNs, evento.instante);
+        processarEvento(&evento);
+    }
+}
+
+// Primeiro os aeroportos deste worker, depois os que ainda nao foram pegos nas listas dos outros
+static void processarJanela() {
+    int workers = simulacao->numeroDeWorkers, i;
+    for (int k = 0; k < workers; k++) {
+        ListaDeTrabalho *lista = &simulacao->listas[(indiceDoWorker + k) % workers];
+        while ((i = atomic_fetch_add_explicit(&lista->proximo, 1, memory_order_relaxed)) < lista->quantidade) {
+            if (k > 0) minhasEstatisticas()->aeroportosRoubados++;
+            processarAeroporto(&simulacao->aeroportos[lista->aeroportos[i]], simulacao->horizonteNs);
+        }
+    }
+}
+
+static void* executarWorkerDaRede(void *arg) {
+    FilaDeEventos *agenda = (FilaDeEventos*)arg;
+    simulacao = agenda->simulacao;
+    indiceDoWorker = agenda - simulacao->agendas;
+    while (1) {
+        pthread_barrier_wait(&simulacao->barreira); // O coordenador montou a janela (ou acabou)
+        if (simulacao->redeEncerrada) break;
+        processarJanela();
+        pthread_barrier_wait(&simulacao->barreira);
+    }
+    return NULL;
+}
+
+// Monta a proxima janela com os workers parados. Retorna 0 quando nao ha mais evento em lugar nenhum.
+static int prepararJanela() {
+    FilaDeEventos *chegadas = &simulacao->agendas[0]; // So tem EV_PROXIMA_CHEGADA
+    int numero = simulacao->config.numeroDeAeroportos, workers = simulacao->numeroDeWorkers;
+    int64_t inicio = INT64_MAX;
+    for (int a = 0; a < numero; a++) {
+        FilaDeEventos *agenda = &simulacao->aeroportos[a].agenda;
+        receberVoosEmTransito(&simulacao->aeroportos[a]);
+        if (agenda->tamanho > 0 && agenda->eventos[0].instante < inicio) inicio = agenda->eventos[0].instante;
+    }
+    if (chegadas->tamanho > 0 && chegadas->eventos[0].instante < inicio) inicio = chegadas->eventos[0].instante;
+    if (inicio == INT64_MAX) return 0;
+    int64_t duracao = (int64_t)simulacao->config.duracaoSegundos * NS_POR_SEGUNDO;
+    int esgotou = inicio >= duracao && simulacao->relogioVirtualNs < duracao;
+    GRAVAR_RELAXADO(simulacao->relogioVirtualNs, inicio);
+    if (esgotou) registrarLog(NULL, MSG_TEMPO_ESGOTADO, -1); // Pelo log, para sair na ordem certa
+    simulacao->horizonteNs = inicio + TEMPO_DE_VOO_MINIMO * NS_POR_SEGUNDO;
+
+    // Os voos novos nascem aqui, antes dos aeroportos rodarem: ninguem agenda nada nas chegadas
+    Evento evento;
+    while (chegadas->tamanho > 0 && chegadas->eventos[0].instante < simulacao->horizonteNs) {
+        retirarEvento(chegadas, &evento);
+        GRAVAR_RELAXADO(simulacao->relogioVirtualNs, evento.instante);
+        processarEvento(&evento);
+    }
+    GRAVAR_RELAXADO(simulacao->relogioVirtualNs, inicio);
+
+    for (int w = 0; w < workers; w++) {
+        simulacao->listas[w].quantidade = 0;
+        atomic_store_explicit(&simulacao->listas[w].proximo, 0, memory_order_relaxed);
+    }
+    for (int a = 0; a < numero; a++) {
+        FilaDeEventos *agenda = &simulacao->aeroportos[a].agenda;
+        if (agenda->tamanho == 0 || agenda->eventos[0].instante >= simulacao->horizonteNs) continue;
+        ListaDeTrabalho *lista = &simulacao->listas[a % workers];
+        lista->aeroportos[lista->quantidade++] = a;
+    }
+    simulacao->janelas++;
+    return 1;
+}
+
+// A thread principal coordena as janelas e tambem trabalha como worker 0
+static void processarRedeVirtual() {
+    int workers = simulacao->numeroDeWorkers;
+    pthread_t *threads = malloc(workers * sizeof(pthread_t));
+    relogioVirtual = &simulacao->relogioVirtualNs;
+    if (!simulacao->restaurada) agendarEvento(0, EV_PROXIMA_CHEGADA, NULL);
+    pthread_barrier_init(&simulacao->barreira, NULL, workers);
+    for (int i = 1; i < workers; i++) pthread_create(&threads[i], NULL, executarWorkerDaRede, &simulacao->agendas[i]);
+    while (1) {
+        relogioVirtual = &simulacao->relogioVirtualNs;
+        gravarInstantaneoSeVenceu(); // Entre janelas, com os workers parados na barreira
+        simulacao->redeEncerrada = !prepararJanela();
+        pthread_barrier_wait(&simulacao->barreira);
+        if (simulacao->redeEncerrada) break;
+        processarJanela();
+        pthread_barrier_wait(&simulacao->barreira);
+    }
+    for (int i = 1; i < workers; i++) pthread_join(threads[i], NULL);
+    pthread_barrier_destroy(&simulacao->barreira);
+    free(threads);
+    // O fim da simulacao e o ultimo evento de qualquer aeroporto
+    for (int a = 0; a < simulacao->config.numeroDeAeroportos; a++) {
+        if (simulacao->aeroportos[a].relogioNs > simulacao->relogioVirtualNs) simulacao->relogioVirtualNs = simulacao->aeroportos[a].relogioNs;
+    }
+}
+
+// ---========= SIMULACAO POR EVENTOS DISCRETOS =========---
+// Mesma maquina de estados, mas com um relogio virtual: em vez de esperar o instante de cada evento,
+// o relogio salta direto para ele. Um dia de trafego roda em segundos.
+
+// Roda a simulacao desta thread ate o ultimo evento
+static void processarAgendaVirtual() {
+    if (simulacao->config.numeroDeAeroportos > 1) {
+        processarRedeVirtual();
+        return;
+    }
+    FilaDeEventos *agenda = &simulacao->agendas[0];
+    relogioVirtual = &simulacao->relogioVirtualNs;
+    if (!simulacao->restaurada) agendarEvento(0, EV_PROXIMA_CHEGADA, NULL);
+    Evento evento;
+    while (gravarInstantaneoSeVenceu(), retirarEvento(agenda, &evento)) {
+        if (evento.instante >= (int64_t)simulacao->config.duracaoSegundos * NS_POR_SEGUNDO && simulacao->relogioVirtualNs < (int64_t)simulacao->config.duracaoSegundos * NS_POR_SEGUNDO) {
+            registrarLog(NULL, MSG_TEMPO_ESGOTADO, -1); // Pelo log, para sair na ordem certa
+        }
+        GRAVAR_RELAXADO(simulacao->relogioVirtualNs, evento.instante);
+        processarEvento(&evento);
+    }
+}
+
+void executarSimulacaoEventos() {
+    struct timespec inicioReal, fimReal;
+    clock_gettime(CLOCK_MONOTONIC, &inicioReal);
+    processarAgendaVirtual();
+    clock_gettime(CLOCK_MONOTONIC, &fimReal);
+    esperarGravacaoDoInstantaneo();
+    finalizarLog(); // Escreve o que sobrou no buffer antes do resumo
+
+    double segundosReais = (fimReal.tv_sec - inicioReal.tv_sec) + (fimReal.tv_nsec - inicioReal.tv_nsec) / 1e9;
+    printf("\n--- Tempo simulado: %.0f s | Tempo real: %.3f s | Voos criados: %d ---\n",
+           (double)simulacao->relogioVirtualNs / NS_POR_SEGUNDO, segundosReais, simulacao->totalDeVoosCriados);
+    if (simulacao->instantaneosGravados > 0) {
+        printf("--- Instantaneos gravados em %s: %d (pausa media do fork: %.3f ms) ---\n", caminhoDoInstantaneo,
+               simulacao->instantaneosGravados, simulacao->pausaDosInstantaneosNs / 1e6 / simulacao->instantaneosGravados);
+    }
+}
+
+int64_t agoraNs() {
+    // No modo de eventos o tempo e o do relogio virtual (na rede, o do aeroporto que esta rodando)
+    if (modoEventos) return LER_RELAXADO(*relogioVirtual);
+    struct timespec agora;
+    clock_gettime(CLOCK_MONOTONIC, &agora);
+    return (int64_t)agora.tv_sec * NS_POR_SEGUNDO + agora.tv_nsec - LER_RELAXADO(simulacao->inicioRealNs);
+}
+
+void registrarLatencia(StatusVoo fase, int64_t inicioNs) {
+    int64_t latencia = agoraNs() - inicioNs;
+    Estatisticas *contadores = minhasEstatisticas();
+    if (fase == POUSANDO) {
+        contadores->somaLatenciaPousoNs += latencia;
+        contadores->pousosConcluidos++;
+    } else {
+        contadores->somaLatenciaDecolagemNs += latencia;
+        contadores->decolagensConcluidas++;
+    }
+}
+
+static int baldeDaLatencia(int64_t ns) {
+    if (ns < (1 << BITS_SUB_BALDE)) return ns < 0 ? 0 : (int)ns;
+    int expoente = 63 - __builtin_clzll((unsigned long long)ns);
+    if (expoente > EXPOENTE_MAXIMO) return BALDES_LATENCIA - 1;
+    int sub = (int)(ns >> (expoente - BITS_SUB_BALDE)) & ((1 << BITS_SUB_BALDE) - 1);
+    return ((expoente - BITS_SUB_BALDE + 1) << BITS_SUB_BALDE) + sub;
+}
+
+// Maior valor que cai no balde
+static int64_t limiteDoBalde(int balde) {
+    if (balde < (1 << BITS_SUB_BALDE)) return balde;
+    int deslocamento = (balde >> BITS_SUB_BALDE) - 1;
+    int64_t inicio = (int64_t)((1 << BITS_SUB_BALDE) + (balde & ((1 << BITS_SUB_BALDE) - 1))) << deslocamento;
+    return inicio + ((int64_t)1 << deslocamento) - 1;
+}
+
+static void registrarNoHistograma(HistogramaLatencia *h, int64_t ns) {
+    h->baldes[baldeDaLatencia(ns)]++;
+    h->contagem++;
+    if (ns > h->maximoNs) h->maximoNs = ns;
+}
+
+static void somarHistograma(HistogramaLatencia *total, const HistogramaLatencia *parcial) {
+    if (parcial->contagem == 0) return;
+    for (int b = 0; b < BALDES_LATENCIA; b++) total->baldes[b] += parcial->baldes[b];
+    total->contagem += parcial->contagem;
+    if (parcial->maximoNs > total->maximoNs) total->maximoNs = parcial->maximoNs;
+}
+
+// Percentil p (0 a 1): o limite do balde onde ele cai, sem passar do maximo registrado
+static int64_t percentilDoHistograma(const HistogramaLatencia *h, double p) {
+    if (h->contagem == 0) return 0;
+    long alvo = (long)(p * h->contagem), acumulado = 0;
+    for (int b = 0; b < BALDES_LATENCIA; b++) {
+        acumulado += h->baldes[b];
+        if (acumulado > alvo) return limiteDoBalde(b) < h->maximoNs ? limiteDoBalde(b) : h->maximoNs;
+    }
+    return h->maximoNs;
+}
+
+// O voo conseguiu todos os recursos da fase no instante agora
+void registrarEspera(const InfoVoo *voo, int64_t agora) {
+    Estatisticas *contadores = minhasEstatisticas();
+    int fase = indiceDaFase(voo->status);
+    SOMAR_RELAXADO(contadores->somaEsperaNs, agora - voo->inicioDaFase);
+    SOMAR_RELAXADO(contadores->esperasConcluidas, 1);
+    registrarNoHistograma(&contadores->esperaDaFase[fase][voo->tipo], agora - voo->inicioDaFase);
+    for (int r = 0; r < NUM_RECURSOS; r++) {
+        if (voo->recursosEmPosse & (1u << r))
+            registrarNoHistograma(&contadores->esperaPeloRecurso[r], voo->concessaoDoRecurso[r] - voo->pedidoDoRecurso[r]);
+    }
+}
+
+// Fim da fase: os recursos do conjunto vao ser devolvidos
+void registrarServico(const InfoVoo *voo, unsigned int conjunto, int64_t agora) {
+    Estatisticas *contadores = minhasEstatisticas();
+    registrarNoHistograma(&contadores->servicoDaFase[indiceDaFase(voo->status)][voo->tipo], agora - voo->inicioDoServico);
+    for (int r = 0; r < NUM_RECURSOS; r++) {
+        if (conjunto & voo->recursosEmPosse & (1u << r))
+            registrarNoHistograma(&contadores->posseDoRecurso[r], agora - voo->concessaoDoRecurso[r]);
+    }
+}
+
+// Percentil p da espera de todas as fases juntas
+int64_t percentilDaEspera(const Estatisticas *e, double p) {
+    static _Thread_local HistogramaLatencia todas;
+    memset(&todas, 0, sizeof(todas));
+    for (int f = 0; f < NUM_FASES; f++) {
+        for (int t = 0; t < 2; t++) somarHistograma(&todas, &e->esperaDaFase[f][t]);
+    }
+    return percentilDoHistograma(&todas, p);
+}
+
+// Soma as fatias dos workers em estatisticas. So chamar com os workers parados.
+void agregarEstatisticas() {
+    memset(&simulacao->estatisticas, 0, sizeof(simulacao->estatisticas));
+    for (int i = 0; i < simulacao->numeroDeWorkers; i++) {
+        Estatisticas *fatia = &simulacao->fatias[i].contadores;
+        simulacao->estatisticas.voosSucesso += fatia->voosSucesso;
+        simulacao->estatisticas.voosAcidentados += fatia->voosAcidentados;
+        simulacao->estatisticas.deadlocksEvitados += fatia->deadlocksEvitados;
+        simulacao->estatisticas.alertasDeStarvation += fatia->alertasDeStarvation;
+        simulacao->estatisticas.somaLatenciaPousoNs += fatia->somaLatenciaPousoNs;
+        simulacao->estatisticas.somaLatenciaDecolagemNs += fatia->somaLatenciaDecolagemNs;
+        simulacao->estatisticas.pousosConcluidos += fatia->pousosConcluidos;
+        simulacao->estatisticas.decolagensConcluidas += fatia->decolagensConcluidas;
+        simulacao->estatisticas.despertares += fatia->despertares;
+        simulacao->estatisticas.concessoes += fatia->concessoes;
+        simulacao->estatisticas.somaEsperaNs += fatia->somaEsperaNs;
+        simulacao->estatisticas.esperasConcluidas += fatia->esperasConcluidas;
+        for (int f = 0; f < NUM_FASES; f++) {
+            for (int t = 0; t < 2; t++) {
+                somarHistograma(&simulacao->estatisticas.esperaDaFase[f][t], &fatia->esperaDaFase[f][t]);
+                somarHistograma(&simulacao->estatisticas.servicoDaFase[f][t], &fatia->servicoDaFase[f][t]);
+            }
+        }
+        for (int s = 0; s < NUM_SITUACOES; s++) simulacao->estatisticas.voosPorSituacao[s] += fatia->voosPorSituacao[s];
+        simulacao->estatisticas.trechosVoados += fatia->trechosVoados;
+        simulacao->estatisticas.aeroportosRoubados += fatia->aeroportosRoubados;
+        if (fatia->picoDeVoosAtivos > simulacao->estatisticas.picoDeVoosAtivos) simulacao->estatisticas.picoDeVoosAtivos = fatia->picoDeVoosAtivos;
+        if (fatia->duracaoTotalNs > simulacao->estatisticas.duracaoTotalNs) simulacao->estatisticas.duracaoTotalNs = fatia->duracaoTotalNs;
+        for (int r = 0; r < NUM_RECURSOS; r++) {
+            PerfilRecurso *total = &simulacao->estatisticas.perfil[r], *parcial = &fatia->perfil[r];
+            total->aquisicoes += parcial->aquisicoes;
+            total->aquisicoesDisputadas += parcial->aquisicoesDisputadas;
+            total->esperaTotalNs += parcial->esperaTotalNs;
+            if (parcial->esperaMaximaNs > total->esperaMaximaNs) total->esperaMaximaNs = parcial->esperaMaximaNs;
+            total->posseTotalNs += parcial->posseTotalNs;
+            total->liberacoesPorBackoff += parcial->liberacoesPorBackoff;
+            somarHistograma(&simulacao->estatisticas.esperaPeloRecurso[r], &fatia->esperaPeloRecurso[r]);
+            somarHistograma(&simulacao->estatisticas.posseDoRecurso[r], &fatia->posseDoRecurso[r]);
+        }
+    }
+}
+
+// Pool cheio e sem ninguem nas filas
+static void iniciarPool(PoolDeRecurso *pool, int capacidade) {
+    pthread_mutex_init(&pool->mutex, NULL);
+    pool->capacidade = pool->disponivel = capacidade;
+    pool->deficit = 0;
+    pool->esperandoCritico = pool->esperandoInternacional = 0;
+    memset(pool->filas, 0, sizeof(pool->filas));
+}
+
+void inicializarAeroporto() {
+    int numero = simulacao->config.numeroDeAeroportos;
+    simulacao->aeroportos = aligned_alloc(_Alignof(Aeroporto), numero * sizeof(Aeroporto));
+    if (simulacao->aeroportos == NULL) { perror("aligned_alloc"); exit(1); }
+    memset(simulacao->aeroportos, 0, numero * sizeof(Aeroporto));
+    // As agendas usam CLOCK_MONOTONIC para dormir ate o instante do evento
+    pthread_condattr_t atributos;
+    pthread_condattr_init(&atributos);
+    pthread_condattr_setclock(&atributos, CLOCK_MONOTONIC);
+    for (int a = 0; a < numero; a++) {
+        Aeroporto *aeroporto = &simulacao->aeroportos[a];
+        for (int r = 0; r < NUM_RECURSOS; r++) iniciarPool(&aeroporto->recursos[r], simulacao->config.capacidade[r]);
+        // Agenda propria, usada so no modo de eventos em rede
+        pthread_mutex_init(&aeroporto->agenda.mutex, NULL);
+        pthread_cond_init(&aeroporto->agenda.cond, &atributos);
+        aeroporto->agenda.simulacao = simulacao;
+        atomic_init(&aeroporto->caixaDeEntrada, NULL);
+    }
+    // Uma agenda por worker
+    simulacao->agendas = calloc(simulacao->numeroDeWorkers, sizeof(FilaDeEventos));
+    for (int i = 0; i < simulacao->numeroDeWorkers; i++) {
+        pthread_mutex_init(&simulacao->agendas[i].mutex, NULL);
+        pthread_cond_init(&simulacao->agendas[i].cond, &atributos);
+        simulacao->agendas[i].simulacao = simulacao;
+    }
+    pthread_condattr_destroy(&atributos);
+    // Listas de trabalho das janelas da rede: cada uma cabe todos os aeroportos
+    simulacao->listas = aligned_alloc(_Alignof(ListaDeTrabalho), simulacao->numeroDeWorkers * sizeof(ListaDeTrabalho));
+    if (simulacao->listas == NULL) { perror("aligned_alloc"); exit(1); }
+    for (int i = 0; i < simulacao->numeroDeWorkers; i++) {
+        atomic_init(&simulacao->listas[i].proximo, 0);
+        simulacao->listas[i].quantidade = 0;
+        simulacao->listas[i].aeroportos = malloc(numero * sizeof(int));
+        if (simulacao->listas[i].aeroportos == NULL) { perror("malloc"); exit(1); }
+    }
+    // Define todas as estatisticas como 0 (uma fatia por worker)
+    memset(&simulacao->estatisticas, 0, sizeof(simulacao->estatisticas));
+    simulacao->fatias = aligned_alloc(_Alignof(FatiaEstatisticas), simulacao->numeroDeWorkers * sizeof(FatiaEstatisticas));
+    if (simulacao->fatias == NULL) { perror("aligned_alloc"); exit(1); }
+    memset(simulacao->fatias, 0, simulacao->numeroDeWorkers * sizeof(FatiaEstatisticas));
+}
+
+void destruirAeroporto() {
+    // Libera todos os mutexes criados
+    for (int a = 0; a < simulacao->config.numeroDeAeroportos; a++) {
+        Aeroporto *aeroporto = &simulacao->aeroportos[a];
+        for (int r = 0; r < NUM_RECURSOS; r++) pthread_mutex_destroy(&aeroporto->recursos[r].mutex);
+        pthread_mutex_destroy(&aeroporto->agenda.mutex);
+        pthread_cond_destroy(&aeroporto->agenda.cond);
+        free(aeroporto->agenda.eventos);
+    }
+    free(simulacao->aeroportos);
+    // Libera as agendas e as listas de trabalho dos workers
+    for (int i = 0; i < simulacao->numeroDeWorkers; i++) {
+        pthread_mutex_destroy(&simulacao->agendas[i].mutex);
+        pthread_cond_destroy(&simulacao->agendas[i].cond);
+        free(simulacao->agendas[i].eventos);
+        free(simulacao->listas[i].aeroportos);
+    }
+    free(simulacao->agendas);
+    free(simulacao->listas);
+    free(simulacao->fatias);
+}
+
+// Cria uma simulacao e a torna a simulacao desta thread
+Simulacao* criarSimulacao(const Configuracao *config, int workers) {
+    simulacao = calloc(1, sizeof(Simulacao));
+    if (simulacao == NULL) { perror("calloc"); exit(1); }
+    simulacao->config = *config;
+    simulacao->numeroDeWorkers = workers;
+    semearGerador(&simulacao->geradorDeChegadas, config->semente, 0); // Fluxo 0: os voos comecam no 1
+    pthread_mutex_init(&simulacao->reservaDeVoos.mutex, NULL);
+    if (config->arquivoDeChegadas != NULL) {
+        abrirArquivoDeChegadas(&simulacao->chegadas, config->arquivoDeChegadas);
+        simulacao->haProximaChegada = lerProximaChegada(&simulacao->chegadas, &simulacao->proximaChegada);
+    }
+    inicializarAeroporto();
+    simulacao->proximoInstantaneoNs = intervaloDoInstantaneoNs;
+    return simulacao;
+}
+
+void descartarSimulacao() {
+    destruirAeroporto();
+    liberarTabelaDeVoos();
+    pthread_mutex_destroy(&simulacao->reservaDeVoos.mutex);
+    if (simulacao->config.arquivoDeChegadas != NULL) fecharArquivoDeChegadas(&simulacao->chegadas);
+    free(simulacao);
+    simulacao = NULL;
+}
+
+// ---========= BANCADA DE DISPUTA =========---
+// Mede se a disputa por um recurso atrasa os outros. Uma thread pega e devolve unidades da Pista
+// enquanto as demais martelam a Torre, e a vazao da Pista e comparada com a dela sozinha. O arranjo
+// compacto e o de antes dos pools: tres mutexes seguidos e os contadores logo depois, de modo que o
+// mutex da Torre e o contador da Pista caem na mesma linha de cache.
 
 typedef struct {
-    int id;
-    TipoVoo tipo;
-    StatusVoo status;
-    int eCritico;
-    time_t inicioDaEspera;
-} InfoVoo;
+    pthread_mutex_t mutex[NUM_RECURSOS];
+    int disponivel[NUM_RECURSOS];
+} RecursosCompactos;
 
 typedef struct {
-    int pistasDisponiveis;
-    pthread_mutex_t mutexPista;
-    pthread_cond_t condPistaCritico, condPistaInternacional, condPistaDomestico;
-    int esperandoPistaCritico, esperandoPistaInternacional;
-
-    int portoesDisponiveis;
-    pthread_mutex_t mutexPortao;
-    pthread_cond_t condPortaoCritico, condPortaoInternacional, condPortaoDomestico;
-    int esperandoPortaoCritico, esperandoPortaoInternacional;
-
-    int torreDisponivel;
-    pthread_mutex_t mutexTorre;
-    pthread_cond_t condTorreCritico, condTorreInternacional, condTorreDomestico;
-    int esperandoTorreCritico, esperandoTorreInternacional;
-} RecursosAeroporto;
+    pthread_t thread;
+    pthread_mutex_t *mutex;
+    int *disponivel;
+    long operacoes;
+} Martelo;
+
+static atomic_int bancadaParada;
+
+static void* executarMartelo(void *arg) {
+    Martelo *martelo = arg;
+    long operacoes = 0;
+    while (!atomic_load_explicit(&bancadaParada, memory_order_relaxed)) {
+        pthread_mutex_lock(martelo->mutex);
+        (*martelo->disponivel)--;
+        (*martelo->disponivel)++;
+        pthread_mutex_unlock(martelo->mutex);
+        operacoes++;
+    }
+    martelo->operacoes = operacoes;
+    return NULL;
+}
+
+// Roda a Pista contra disputantes na Torre por duracaoMs; devolve as operacoes por segundo da Pista
+static double medirDisputa(pthread_mutex_t *mutex[NUM_RECURSOS], int *disponivel[NUM_RECURSOS],
+                           int disputantes, long duracaoMs, double *vazaoDaTorre) {
+    Martelo martelos[1 + disputantes];
+    atomic_store(&bancadaParada, 0);
+    for (int i = 0; i <= disputantes; i++) {
+        TipoRecurso tipo = i == 0 ? PISTA : TORRE;
+        martelos[i] = (Martelo){ .mutex = mutex[tipo], .disponivel = disponivel[tipo] };
+        pthread_create(&martelos[i].thread, NULL, executarMartelo, &martelos[i]);
+    }
+    struct timespec pausa = { duracaoMs / 1000, (duracaoMs % 1000) * NS_POR_MILISSEGUNDO };
+    nanosleep(&pausa, NULL);
+    atomic_store(&bancadaParada, 1);
+    long daTorre = 0;
+    for (int i = 0; i <= disputantes; i++) {
+        pthread_join(martelos[i].thread, NULL);
+        if (i > 0) daTorre += martelos[i].operacoes;
+    }
+    if (vazaoDaTorre != NULL) *vazaoDaTorre = daTorre * 1000.0 / duracaoMs;
+    return martelos[0].operacoes * 1000.0 / duracaoMs;
+}
+
+int executarBancada(long duracaoMs, int threads) {
+    int disputantes = threads > 1 ? threads - 1 : 1;
+    static PoolDeRecurso pools[NUM_RECURSOS];
+    static RecursosCompactos compactos;
+    pthread_mutex_t *mutexDosPools[NUM_RECURSOS], *mutexCompactos[NUM_RECURSOS];
+    int *disponivelDosPools[NUM_RECURSOS], *disponivelCompactos[NUM_RECURSOS];
+    for (int r = 0; r < NUM_RECURSOS; r++) {
+        iniciarPool(&pools[r], tiposDeRecurso[r].capacidadePadrao);
+        pthread_mutex_init(&compactos.mutex[r], NULL);
+        compactos.disponivel[r] = tiposDeRecurso[r].capacidadePadrao;
+        mutexDosPools[r] = &pools[r].mutex;
+        disponivelDosPools[r] = &pools[r].disponivel;
+        mutexCompactos[r] = &compactos.mutex[r];
+        disponivelCompactos[r] = &compactos.disponivel[r];
+    }
+    printf("--- Bancada de disputa: Pista contra %d thread(s) na Torre, %ld ms cada ---\n", disputantes, duracaoMs);
+    printf("PoolDeRecurso: %zu bytes; arranjo compacto: %zu bytes\n", sizeof(PoolDeRecurso), sizeof(RecursosCompactos));
+    double torre, sozinha = medirDisputa(mutexDosPools, disponivelDosPools, 0, duracaoMs, NULL);
+    printf("%-28s %10.2f Mops/s na Pista\n", "Pista sozinha", sozinha / 1e6);
+    double compacta = medirDisputa(mutexCompactos, disponivelCompactos, disputantes, duracaoMs, &torre);
+    printf("%-28s %10.2f Mops/s na Pista (%5.1f%%), %8.2f na Torre\n", "Compacto, Torre disputada",
+           compacta / 1e6, 100.0 * compacta / sozinha, torre / 1e6);
+    double alinhada = medirDisputa(mutexDosPools, disponivelDosPools, disputantes, duracaoMs, &torre);
+    printf("%-28s %10.2f Mops/s na Pista (%5.1f%%), %8.2f na Torre\n", "Pools, Torre disputada",
+           alinhada / 1e6, 100.0 * alinhada / sozinha, torre / 1e6);
+    for (int r = 0; r < NUM_RECURSOS; r++) {
+        pthread_mutex_destroy(&pools[r].mutex);
+        pthread_mutex_destroy(&compactos.mutex[r]);
+    }
+    return 0;
+}
+
+// ---========= VARREDURA DE PARAMETROS =========---
+// Cada combinacao de parametros roda com varias sementes. Cada rodada e uma simulacao por eventos
+// com o proprio contexto (Simulacao), entao as threads so dividem a lista de rodadas.
+// Todas as combinacoes usam as mesmas sementes, para a comparacao entre elas ser justa.
 
 typedef struct {
-    int voosSucesso, voosAcidentados, deadlocksEvitados, alertasDeStarvation;
-    pthread_mutex_t mutexEstatisticas;
-} Estatisticas;
+    double inicio, fim, passo;
+} Intervalo;
 
-RecursosAeroporto aeroporto;
-Estatisticas estatisticas;
-InfoVoo todosOsVoos[MAX_VOOS];
-int totalDeVoosCriados = 0;
+enum { PARAM_PISTAS, PARAM_PORTOES, PARAM_TORRE, PARAM_FOME, PARAM_QUEDA, PARAM_INTERNACIONAL, NUM_PARAMETROS };
+static const char *nomesDosParametros[NUM_PARAMETROS] = { "pistas", "portoes", "torre", "fome", "queda", "internacional" };
 
-void inicializarAeroporto();
-void destruirAeroporto();
-void* cicloDeVidaDoAviao(void *arg);
-void imprimirRelatorioFinal();
-void logEvento(int id, TipoVoo tipo, const char* mensagem);
-int solicitarRecurso(InfoVoo *voo, const char* nomeRecurso, pthread_mutex_t *mutex, pthread_cond_t *conds[3], int *recursoDisponivel, int *esperandoCritico, int *esperandoInternacional);
-void liberarRecurso(pthread_mutex_t *mutex, pthread_cond_t *conds[3], int *recursoDisponivel, int *esperandoCritico, int *esperandoInternacional);
-const char* getStatusEmTexto(StatusVoo status);
+// So o que a tabela usa: guardar as Estatisticas inteiras (com os histogramas) de cada rodada pesa
+typedef struct {
+    Configuracao config;
+    int voosCriados, voosSucesso, voosAcidentados;
+    int64_t somaEsperaNs;
+    long esperasConcluidas;
+    HistogramaLatencia espera;      // Todas as fases juntas
+} Rodada;
 
-int main() {
-    srand(time(NULL));
-    inicializarAeroporto();
-    printf("--- Simulacao De controle de Trafego Aereo ---\n");
-    printf("--- Ordem de Prioridade: 1.Critico -> 2.Internacional -> 3.Domestico ---\n");
-    time_t inicio_simulacao = time(NULL);
-    pthread_t threads[MAX_VOOS];
-    while (time(NULL) - inicio_simulacao < TEMPO_SIMULACAO_MINUTOS * 60) {
-        if (totalDeVoosCriados < MAX_VOOS) {
-            InfoVoo* info = &todosOsVoos[totalDeVoosCriados];
-            info->id = totalDeVoosCriados + 1;
-            info->tipo = (rand() % 3 == 0) ? INTERNACIONAL : DOMESTICO;
-            info->status = AGUARDANDO;
-            info->eCritico = 0;
-            pthread_create(&threads[totalDeVoosCriados], NULL, cicloDeVidaDoAviao, (void*)info);
-            totalDeVoosCriados++;
-        }
-        sleep(TEMPO_BASE_OPERACAO);
-    }
-    printf("\n--- TEMPO DE SIMULACAO ESGOTADO. Aguardando operacoes restantes... ---\n");
-    for (int i = 0; i < totalDeVoosCriados; i++) {
-        pthread_join(threads[i], NULL);
+static Rodada *rodadas;
+static int totalDeRodadas;
+static atomic_int proximaRodada;
+
+// Aceita "valor", "inicio:fim" ou "inicio:fim:passo"
+static int lerIntervalo(const char *texto, Intervalo *intervalo, double passoPadrao) {
+    char *fim;
+    intervalo->inicio = intervalo->fim = strtod(texto, &fim);
+    intervalo->passo = passoPadrao;
+    if (*fim == ':') {
+        intervalo->fim = strtod(fim + 1, &fim);
+        if (*fim == ':') intervalo->passo = strtod(fim + 1, &fim);
     }
-    imprimirRelatorioFinal();
-    destruirAeroporto();
+    return fim != texto && *fim == '\0' && intervalo->passo > 0 && intervalo->fim >= intervalo->inicio;
+}
+
+static int quantidadeDeValores(const Intervalo *intervalo) {
+    return (int)((intervalo->fim - intervalo->inicio) / intervalo->passo + 1e-9) + 1;
+}
+
+static void* executarRodadas(void *arg) {
+    (void)arg;
+    int i;
+    while ((i = atomic_fetch_add(&proximaRodada, 1)) < totalDeRodadas) {
+        criarSimulacao(&rodadas[i].config, 1);
+        if (instantaneoDeOrigem != NULL) restaurarInstantaneo();
+        processarAgendaVirtual();
+        agregarEstatisticas();
+        Estatisticas *e = &simulacao->estatisticas;
+        rodadas[i].voosCriados = simulacao->totalDeVoosCriados;
+        rodadas[i].voosSucesso = e->voosSucesso;
+        rodadas[i].voosAcidentados = e->voosAcidentados;
+        rodadas[i].somaEsperaNs = e->somaEsperaNs;
+        rodadas[i].esperasConcluidas = e->esperasConcluidas;
+        for (int f = 0; f < NUM_FASES; f++) {
+            for (int t = 0; t < 2; t++) somarHistograma(&rodadas[i].espera, &e->esperaDaFase[f][t]);
+        }
+        descartarSimulacao();
+    }
+    return NULL;
+}
+
+int executarVarredura(const char *especificacao, int threads) {
+    Configuracao *base = &configuracaoBase;
+    Intervalo intervalos[NUM_PARAMETROS] = {
+        { base->capacidade[PISTA], base->capacidade[PISTA], 1 }, { base->capacidade[PORTAO], base->capacidade[PORTAO], 1 },
+        { base->capacidade[TORRE], base->capacidade[TORRE], 1 }, { base->alertaFomeSegundos, base->alertaFomeSegundos, 1 },
+        { base->quedaAviaoSegundos, base->quedaAviaoSegundos, 1 },
+        { base->fracaoInternacional, base->fracaoInternacional, 0.1 },
+    };
+    int sementes = 4;
+    char *copia = strdup(especificacao), *resto = NULL;
+    for (char *item = strtok_r(copia, ",", &resto); item != NULL; item = strtok_r(NULL, ",", &resto)) {
+        char *valor = strchr(item, '=');
+        int p = 0;
+        if (valor != NULL) *valor++ = '\0';
+        if (valor != NULL && strcmp(item, "sementes") == 0 && (sementes = atoi(valor)) > 0) continue;
+        while (p < NUM_PARAMETROS && (valor == NULL || strcmp(item, nomesDosParametros[p]) != 0)) p++;
+        if (p == NUM_PARAMETROS || !lerIntervalo(valor, &intervalos[p], p == PARAM_INTERNACIONAL ? 0.1 : 1)) {
+            fprintf(stderr, "Varredura invalida perto de '%s'\n", item);
+            free(copia);
+            return 1;
+        }
+    }
+    free(copia);
+    if (intervalos[PARAM_PISTAS].inicio < 1 || intervalos[PARAM_PORTOES].inicio < 1 || intervalos[PARAM_TORRE].inicio < 1) {
+        fprintf(stderr, "Varredura invalida: precisa de pelo menos 1 pista, 1 portao e 1 vaga na torre\n");
+        return 1;
+    }
+
+    // Monta as rodadas: todas as combinacoes (contador de base mista) x sementes
+    int configuracoes = 1;
+    for (int p = 0; p < NUM_PARAMETROS; p++) configuracoes *= quantidadeDeValores(&intervalos[p]);
+    totalDeRodadas = configuracoes * sementes;
+    rodadas = calloc(totalDeRodadas, sizeof(Rodada));
+    if (rodadas == NULL) { perror("calloc"); return 1; }
+    for (int c = 0; c < configuracoes; c++) {
+        double valores[NUM_PARAMETROS];
+        for (int p = 0, resto = c; p < NUM_PARAMETROS; p++) {
+            int n = quantidadeDeValores(&intervalos[p]);
+            valores[p] = intervalos[p].inicio + (resto % n) * intervalos[p].passo;
+            resto /= n;
+        }
+        Configuracao config = *base;
+        config.capacidade[PISTA] = (int)(valores[PARAM_PISTAS] + 0.5);
+        config.capacidade[PORTAO] = (int)(valores[PARAM_PORTOES] + 0.5);
+        config.capacidade[TORRE] = (int)(valores[PARAM_TORRE] + 0.5);
+        config.alertaFomeSegundos = (int)(valores[PARAM_FOME] + 0.5);
+        config.quedaAviaoSegundos = (int)(valores[PARAM_QUEDA] + 0.5);
+        config.fracaoInternacional = valores[PARAM_INTERNACIONAL];
+        for (int s = 0; s < sementes; s++) {
+            rodadas[c * sementes + s].config = config;
+            rodadas[c * sementes + s].config.semente = base->semente + s;
+        }
+    }
+
+    // Roda tudo em paralelo
+    modoEventos = 1;
+    modoVarredura = 1;
+    if (threads > totalDeRodadas) threads = totalDeRodadas;
+    struct timespec inicioReal, fimReal;
+    clock_gettime(CLOCK_MONOTONIC, &inicioReal);
+    atomic_init(&proximaRodada, 0);
+    pthread_t *executores = malloc(threads * sizeof(pthread_t));
+    for (int i = 0; i < threads; i++) pthread_create(&executores[i], NULL, executarRodadas, NULL);
+    for (int i = 0; i < threads; i++) pthread_join(executores[i], NULL);
+    free(executores);
+    clock_gettime(CLOCK_MONOTONIC, &fimReal);
+
+    // Uma linha por combinacao, somando as sementes
+    printf("--- Varredura: %d configuracoes x %d sementes (a partir de %llu) = %d simulacoes de %d min em %d threads (%.2f s) ---\n",
+           configuracoes, sementes, (unsigned long long)base->semente, totalDeRodadas, base->duracaoSegundos / 60, threads,
+           (fimReal.tv_sec - inicioReal.tv_sec) + (fimReal.tv_nsec - inicioReal.tv_nsec) / 1e9);
+    printf("%6s %7s %5s %5s %5s %6s %9s %9s %8s %12s %11s\n", "Pistas", "Portoes", "Torre", "Fome", "Queda",
+           "Intl%", "Voos/sim", "Sucesso%", "Queda%", "Espera med.", "Espera p99");
+    Rodada *soma = malloc(sizeof(Rodada));
+    for (int c = 0; c < configuracoes; c++) {
+        memset(soma, 0, sizeof(Rodada));
+        long criados = 0;
+        for (int s = 0; s < sementes; s++) {
+            Rodada *e = &rodadas[c * sementes + s];
+            criados += e->voosCriados;
+            soma->voosSucesso += e->voosSucesso;
+            soma->voosAcidentados += e->voosAcidentados;
+            soma->somaEsperaNs += e->somaEsperaNs;
+            soma->esperasConcluidas += e->esperasConcluidas;
+            somarHistograma(&soma->espera, &e->espera);
+        }
+        Configuracao *config = &rodadas[c * sementes].config;
+        printf("%6d %7d %5d %5d %5d %6.1f %9.1f %9.2f %8.2f %10.2f s %9.1f s\n", config->capacidade[PISTA],
+               config->capacidade[PORTAO], config->capacidade[TORRE], config->alertaFomeSegundos, config->quedaAviaoSegundos,
+               config->fracaoInternacional * 100, (double)criados / sementes,
+               criados ? 100.0 * soma->voosSucesso / criados : 0.0, criados ? 100.0 * soma->voosAcidentados / criados : 0.0,
+               soma->esperasConcluidas ? (double)soma->somaEsperaNs / soma->esperasConcluidas / NS_POR_SEGUNDO : 0.0,
+               (double)percentilDoHistograma(&soma->espera, 0.99) / NS_POR_SEGUNDO);
+    }
+    free(soma);
+    free(rodadas);
     return 0;
 }
 
-void* cicloDeVidaDoAviao(void* arg) {
-    // Define o arg para a struct de voo
-    InfoVoo *voo = (InfoVoo*)arg;
-    // Arrays para as condicionais de cada recurso e prioridade
-    // São passados para as funções que pedem/liberam recursos
-    pthread_cond_t *condsPista[3] = {&aeroporto.condPistaCritico, &aeroporto.condPistaInternacional, &aeroporto.condPistaDomestico};
-    pthread_cond_t *condsTorre[3] = {&aeroporto.condTorreCritico, &aeroporto.condTorreInternacional, &aeroporto.condTorreDomestico};
-    pthread_cond_t *condsPortao[3] = {&aeroporto.condPortaoCritico, &aeroporto.condPortaoInternacional, &aeroporto.condPortaoDomestico};
-
-    // ---========= POUSO =========---
-    voo->status = POUSANDO; // Define o status do voo para POUSANDO
-    voo->inicioDaEspera = time(NULL); // Marca o inicio da espera
-    logEvento(voo->id, voo->tipo, "iniciando procedimento de pouso.");
-    while (1) { // Loop até conseguir os dois recursos necessarios
-        if (voo->tipo == INTERNACIONAL) { // Voo Internacional. Ordem: Pista -> Torre
-            // Se solicitar_recurso retornar 1, conseguiu pista, tenta torre...
-            if (solicitarRecurso(voo, "Pista", &aeroporto.mutexPista, condsPista, &aeroporto.pistasDisponiveis, &aeroporto.esperandoPistaCritico, &aeroporto.esperandoPistaInternacional)) {
-                // Se conseguir torre(retorna 1) faz o break e sai do Loop
-                if (solicitarRecurso(voo, "Torre", &aeroporto.mutexTorre, condsTorre, &aeroporto.torreDisponivel, &aeroporto.esperandoTorreCritico, &aeroporto.esperandoTorreInternacional)) {
-                    break; // Sai do Loop
-                } else {
-                    // Se não conseguir torre, verifica se o tempo acabou(caiu)
-                    if (voo->status == ACIDENTE) return NULL;
-                    // Se não caiu loga e libera a pista que tinha pegado.
-                    logEvento(voo->id, voo->tipo, "Timeout para pegar Torre. Devolvendo Pista e tentando de novo...");
-                    liberarRecurso(&aeroporto.mutexPista, condsPista, &aeroporto.pistasDisponiveis, &aeroporto.esperandoPistaCritico, &aeroporto.esperandoPistaInternacional);
-                }
+// ---========= LOG ASSINCRONO =========---
+// Os voos nao formatam nem escrevem nada: cada evento vira um registro binario de tamanho fixo
+// num buffer circular sem trava (varios produtores, um consumidor). Uma thread de log separada
+// formata os registros e escreve no stdout em lotes.
+// Com -r, a mesma thread grava os registros crus (RegistroLog, 16 bytes) no arquivo de rastro,
+// tambem em lotes, e os eventos que so existem no rastro passam pelo buffer (ver rastro.h).
+
+static const char *textosDeLog[] = {
+    [MSG_INICIO_POUSO] = "iniciando procedimento de pouso.",
+    [MSG_POUSO_CONCLUIDO] = "pouso concluido. Liberando recursos.",
+    [MSG_DESEMBARCANDO] = "desembarcando...",
+    [MSG_INICIO_DECOLAGEM] = "iniciando procedimento de decolagem.",
+    [MSG_DECOLAGEM_CONCLUIDA] = "decolagem concluida. Liberando todos os recursos.",
+    [MSG_MAYDAY] = "MAYDAY! MAYDAY! Risco de fome!",
+    [MSG_QUEDA] = "CAIU! Tempo de espera excedeu o limite.",
+    [MSG_TIMEOUT] = "Timeout para pegar %s. Devolvendo %s e tentando de novo...",
+    [MSG_TEMPO_ESGOTADO] = "TEMPO DE SIMULACAO ESGOTADO. Aguardando operacoes restantes...",
+};
+
+// Cada celula tem um numero de sequencia que diz se ela esta livre para a posicao de escrita
+// atual ou pronta para a posicao de leitura atual (fila limitada de Vyukov)
+typedef struct {
+    atomic_size_t sequencia;
+    RegistroLog registro;
+} CelulaLog;
+
+typedef struct {
+    CelulaLog *celulas;
+    size_t mascara;
+    _Alignas(64) atomic_size_t posicaoEscrita; // Disputada pelos produtores
+    _Alignas(64) size_t posicaoLeitura;        // So o consumidor mexe
+    atomic_ulong descartados;
+    atomic_int encerrando;
+    pthread_t consumidor;
+    int64_t inicioDeParedeNs;   // CLOCK_REALTIME no inicio, para o horario do log em tempo real
+    int rastro;                 // Arquivo de rastro (-1 sem -r)
+    int emRede;                 // Mais de um aeroporto: as linhas dizem em qual
+    unsigned long registrosNoRastro;
+} BufferDeLog;
+
+BufferDeLog bufferDeLog;
+
+// Mensagens com texto que vao para o stdout (as outras sao so do rastro)
+static int saiNoTexto(const RegistroLog *registro) {
+    return registro->mensagem <= MSG_TEMPO_ESGOTADO && (!modoSilencioso || registro->voo < 0) && !modoVarredura;
+}
+
+// voo NULL para avisos da simulacao
+void registrarLog(const InfoVoo *voo, MensagemLog mensagem, int recurso) {
+    RegistroLog registro;
+    registro.instante = agoraNs();
+    registro.voo = voo ? voo->codigo : -1;
+    registro.mensagem = mensagem;
+    registro.fase = voo ? voo->status : 0;
+    registro.recurso = recurso;
+    registro.tipo = voo ? voo->tipo | (voo->eCritico ? RASTRO_CRITICO : 0) | voo->aeroporto << 2 : 0;
+    if (!rastreando && !saiNoTexto(&registro)) return;
+
+    size_t posicao = atomic_load_explicit(&bufferDeLog.posicaoEscrita, memory_order_relaxed);
+    while (1) {
+        CelulaLog *celula = &bufferDeLog.celulas[posicao & bufferDeLog.mascara];
+        size_t sequencia = atomic_load_explicit(&celula->sequencia, memory_order_acquire);
+        intptr_t diferenca = (intptr_t)sequencia - (intptr_t)posicao;
+        if (diferenca == 0) {
+            // Celula livre: tenta reservar a posicao
+            if (atomic_compare_exchange_weak_explicit(&bufferDeLog.posicaoEscrita, &posicao, posicao + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                celula->registro = registro;
+                atomic_store_explicit(&celula->sequencia, posicao + 1, memory_order_release);
+                return;
             }
-        } else { // Voo Doméstico Ordem: Torre -> Pista
-            // Se solicitar_recurso retornar 1, conseguiu torre, tenta pista...
-            if (solicitarRecurso(voo, "Torre", &aeroporto.mutexTorre, condsTorre, &aeroporto.torreDisponivel, &aeroporto.esperandoTorreCritico, &aeroporto.esperandoTorreInternacional)) {
-                // // Se conseguir pista(retorna 1) faz o break e sai do Loop
-                if (solicitarRecurso(voo, "Pista", &aeroporto.mutexPista, condsPista, &aeroporto.pistasDisponiveis, &aeroporto.esperandoPistaCritico, &aeroporto.esperandoPistaInternacional)) {
-                    break; // Sai do Loop
-                } else {
-                    // Se não conseguir uma pista, verifica se o tempo acabou(caiu)
-                    if (voo->status == ACIDENTE) return NULL;
-                    // Se não caiu loga e libera a torre que tinha pegado.
-                    logEvento(voo->id, voo->tipo, "Timeout para pegar Pista. Devolvendo Torre e tentando de novo...");
-                    liberarRecurso(&aeroporto.mutexTorre, condsTorre, &aeroporto.torreDisponivel, &aeroporto.esperandoTorreCritico, &aeroporto.esperandoTorreInternacional);
-                }
+        } else if (diferenca < 0) {
+            // Buffer cheio: o consumidor ainda nao leu esta celula
+            if (politicaLog == LOG_DESCARTAR) {
+                atomic_fetch_add_explicit(&bufferDeLog.descartados, 1, memory_order_relaxed);
+                return;
             }
+            sched_yield();
+            posicao = atomic_load_explicit(&bufferDeLog.posicaoEscrita, memory_order_relaxed);
+        } else {
+            // Outro produtor pegou a posicao antes
+            posicao = atomic_load_explicit(&bufferDeLog.posicaoEscrita, memory_order_relaxed);
         }
-        if(voo->status == ACIDENTE) return NULL; // Após as tentativas verifica se caiu
-        sleep(rand() % 3 + 1); // Espera aleatoriamente entre as tentativas 
-    }
-    // Conseguiu sair do Loop, então conseguiu pousar e libera o recurso
-    sleep((TEMPO_BASE_OPERACAO * 0.1) + (TEMPO_BASE_OPERACAO * 0.5)); // Precisa de torre e pista
-    logEvento(voo->id, voo->tipo, "pouso concluido. Liberando recursos.");
-    liberarRecurso(&aeroporto.mutexPista, condsPista, &aeroporto.pistasDisponiveis, &aeroporto.esperandoPistaCritico, &aeroporto.esperandoPistaInternacional);
-    liberarRecurso(&aeroporto.mutexTorre, condsTorre, &aeroporto.torreDisponivel, &aeroporto.esperandoTorreCritico, &aeroporto.esperandoTorreInternacional);
-
-    // ---========= DESEMBARQUE =========---
-    voo->status = DESEMBARCANDO; // Define o status do voo para DESEMBARCANDO
-    // voo->inicioDaEspera = time(NULL);
-    while (1) { // Loop até conseguir os dois recursos necessarios
-        if (voo->tipo == INTERNACIONAL) { // Voo Internacional. Ordem: Portão -> Torre
-            // Se solicitar_recurso retornar 1, conseguiu portão, tenta torre...
-            if (solicitarRecurso(voo, "Portao", &aeroporto.mutexPortao, condsPortao, &aeroporto.portoesDisponiveis, &aeroporto.esperandoPortaoCritico, &aeroporto.esperandoPortaoInternacional)) {
-                // Se conseguir torre(retorna 1) faz o break e sai do Loop
-                if (solicitarRecurso(voo, "Torre", &aeroporto.mutexTorre, condsTorre, &aeroporto.torreDisponivel, &aeroporto.esperandoTorreCritico, &aeroporto.esperandoTorreInternacional)) {
-                    break; // Sai do Loop
-                } else {
-                    // Se não conseguir torre, verifica se o tempo acabou(caiu)
-                    if (voo->status == ACIDENTE) return NULL;
-                    // Se não caiu loga e libera o portão que tinha pegado.
-                    logEvento(voo->id, voo->tipo, "Timeout para pegar Torre. Devolvendo Portao e tentando de novo...");
-                    liberarRecurso(&aeroporto.mutexPortao, condsPortao, &aeroporto.portoesDisponiveis, &aeroporto.esperandoPortaoCritico, &aeroporto.esperandoPortaoInternacional);
-                }
-            }
-        } else { // Voo Doméstico Ordem: Torre -> Portão
-            // Se solicitar_recurso retornar 1, conseguiu torre, tenta pista...
-            if (solicitarRecurso(voo, "Torre", &aeroporto.mutexTorre, condsTorre, &aeroporto.torreDisponivel, &aeroporto.esperandoTorreCritico, &aeroporto.esperandoTorreInternacional)) {
-                // // Se conseguir o portão(retorna 1) faz o break e sai do Loop
-                if (solicitarRecurso(voo, "Portao", &aeroporto.mutexPortao, condsPortao, &aeroporto.portoesDisponiveis, &aeroporto.esperandoPortaoCritico, &aeroporto.esperandoPortaoInternacional)) {
-                    break; // Sai do Loop
-                } else {
-                    // Se não conseguir um portão, verifica se o tempo acabou(caiu)
-                    if (voo->status == ACIDENTE) return NULL;
-                    // Se não caiu loga e libera a torre que tinha pegado.
-                    logEvento(voo->id, voo->tipo, "Timeout para pegar Portao. Devolvendo Torre e tentando de novo...");
-                    liberarRecurso(&aeroporto.mutexTorre, condsTorre, &aeroporto.torreDisponivel, &aeroporto.esperandoTorreCritico, &aeroporto.esperandoTorreInternacional);
-                }
-            }
+    }
+}
+
+void logEvento(const InfoVoo *voo, MensagemLog mensagem) {
+    registrarLog(voo, mensagem, -1);
+}
+
+static size_t formatarRegistro(const RegistroLog *registro, char *destino, size_t espaco) {
+    if (registro->voo < 0) {
+        int n = snprintf(destino, espaco, "\n--- %s ---\n", textosDeLog[registro->mensagem]);
+        return n < 0 ? 0 : ((size_t)n < espaco ? (size_t)n : espaco - 1);
+    }
+    char buf[30];
+    if (modoEventos) {
+        // No modo de eventos o horario e o do relogio virtual, a partir de 00:00:00
+        long long segundos = registro->instante / NS_POR_SEGUNDO;
+        snprintf(buf, 30, "%02lld:%02lld:%02lld", segundos / 3600, (segundos / 60) % 60, segundos % 60);
+    } else {
+        time_t instante = (bufferDeLog.inicioDeParedeNs + registro->instante) / NS_POR_SEGUNDO; struct tm tm;
+        strftime(buf, 30, "%H:%M:%S", localtime_r(&instante, &tm));
+    }
+    char texto[96];
+    const char *mensagem = textosDeLog[registro->mensagem];
+    if (registro->mensagem == MSG_TIMEOUT) {
+        // O segundo %s e o primeiro recurso da ordem de aquisicao da fase, o que o voo devolve
+        int tipo = registro->tipo & 1;
+        snprintf(texto, sizeof(texto), mensagem, nomesDosRecursos[registro->recurso],
+                 nomesDosRecursos[ordemDeAquisicao[indiceDaFase(registro->fase)][tipo][0]]);
+        mensagem = texto;
+    }
+    char aeroporto[16] = "";
+    if (bufferDeLog.emRede) snprintf(aeroporto, sizeof(aeroporto), "[A%02d] ", RASTRO_AEROPORTO(registro->tipo));
+    int n = snprintf(destino, espaco, "[%s] %sVoo %03d (%s): %s\n", buf, aeroporto, registro->voo,
+                     (registro->tipo & 1) == INTERNACIONAL ? "Internacional" : "Domestico   ", mensagem);
+    return n < 0 ? 0 : ((size_t)n < espaco ? (size_t)n : espaco - 1);
+}
+
+// Escreve tudo, repetindo se o write() gravar so parte. So chama write(): serve tambem no filho
+// do fork() que grava o instantaneo. Retorna -1 se falhar.
+static int escreverTudo(int fd, const void *dados, size_t tamanho) {
+    const char *p = dados;
+    while (tamanho > 0) {
+        ssize_t n = write(fd, p, tamanho);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
         }
-        if(voo->status == ACIDENTE) return NULL; // Após as tentativas verifica se caiu
-        sleep(rand() % 3 + 1); // Espera aleatoriamente entre as tentativas 
+        p += n;
+        tamanho -= n;
     }
-    // Conseguiu sair do Loop, loga desembarcando e libera recursos
-    logEvento(voo->id, voo->tipo, "desembarcando...");
-    sleep(((TEMPO_BASE_OPERACAO * 1) + (TEMPO_BASE_OPERACAO * 0.1))); // precisa de portao e torre
-    liberarRecurso(&aeroporto.mutexTorre, condsTorre, &aeroporto.torreDisponivel, &aeroporto.esperandoTorreCritico, &aeroporto.esperandoTorreInternacional);
-    liberarRecurso(&aeroporto.mutexPortao, condsPortao, &aeroporto.portoesDisponiveis, &aeroporto.esperandoPortaoCritico, &aeroporto.esperandoPortaoInternacional);
+    return 0;
+}
+
+static void escreverNoRastro(const void *dados, size_t tamanho) {
+    if (escreverTudo(bufferDeLog.rastro, dados, tamanho) < 0) perror(caminhoDoRastro);
+}
 
-    // ---========= DECOLAGEM =========---
-    voo->status = DECOLANDO; // Define o status do voo para DECOLANDO
-    logEvento(voo->id, voo->tipo, "iniciando procedimento de decolagem.");
-    // voo->inicioDaEspera = time(NULL);
+// Le e escreve o que estiver pronto, ate LOTE_LOG linhas por escrita no stdout e LOTE_RASTRO
+// registros por escrita no rastro. Retorna quantos leu.
+static size_t esvaziarBufferDeLog() {
+    static char saida[LOTE_LOG * 160];
+    static RegistroLog lote[LOTE_RASTRO];
+    size_t lidos = 0, usado = 0, linhas = 0, noLote = 0;
     while (1) {
-        if (voo->tipo == INTERNACIONAL) { // Voo Internacional. Ordem: Portão -> Pista -> Torre
-            // Tenta pegar portão
-            if (solicitarRecurso(voo, "Portao", &aeroporto.mutexPortao, condsPortao, &aeroporto.portoesDisponiveis, &aeroporto.esperandoPortaoCritico, &aeroporto.esperandoPortaoInternacional)) {
-                // Tenta pegar pista
-                if (solicitarRecurso(voo, "Pista", &aeroporto.mutexPista, condsPista, &aeroporto.pistasDisponiveis, &aeroporto.esperandoPistaCritico, &aeroporto.esperandoPistaInternacional)) {
-                    // Tenta pegar torre
-                    if (solicitarRecurso(voo, "Torre", &aeroporto.mutexTorre, condsTorre, &aeroporto.torreDisponivel, &aeroporto.esperandoTorreCritico, &aeroporto.esperandoTorreInternacional)) {
-                        break; // Se conseguiu pegar tudo sai do loop
-                    } else {
-                        // Se não conseguiu pegar torre, libera os outros recursos
-                        liberarRecurso(&aeroporto.mutexPortao, condsPortao, &aeroporto.portoesDisponiveis, &aeroporto.esperandoPortaoCritico, &aeroporto.esperandoPortaoInternacional);
-                        liberarRecurso(&aeroporto.mutexPista, condsPista, &aeroporto.pistasDisponiveis, &aeroporto.esperandoPistaCritico, &aeroporto.esperandoPistaInternacional);
-                        if (voo->status == ACIDENTE) return NULL; // verifica se o avião caiu e termina a thread
-                    }
-                } else {
-                    // Se não conseguiu pista, libera o portão que tinha pegado
-                    liberarRecurso(&aeroporto.mutexPortao, condsPortao, &aeroporto.portoesDisponiveis, &aeroporto.esperandoPortaoCritico, &aeroporto.esperandoPortaoInternacional);
-                    if (voo->status == ACIDENTE) return NULL; // Se caiu retorna NULL
-                }
+        CelulaLog *celula = &bufferDeLog.celulas[bufferDeLog.posicaoLeitura & bufferDeLog.mascara];
+        size_t sequencia = atomic_load_explicit(&celula->sequencia, memory_order_acquire);
+        if (sequencia != bufferDeLog.posicaoLeitura + 1) break; // Nada pronto nesta posicao
+        if (bufferDeLog.rastro >= 0) {
+            lote[noLote++] = celula->registro;
+            if (noLote == LOTE_RASTRO) {
+                escreverNoRastro(lote, sizeof(lote));
+                noLote = 0;
             }
-        } else { // Voo Doméstico Ordem: Torre -> Portão -> Pista
-            // Tenta pegar TORRE
-            if (solicitarRecurso(voo, "Torre", &aeroporto.mutexTorre, condsTorre, &aeroporto.torreDisponivel, &aeroporto.esperandoTorreCritico, &aeroporto.esperandoTorreInternacional)) {
-                // Tenta pegar PORTÃO
-                if (solicitarRecurso(voo, "Portao", &aeroporto.mutexPortao, condsPortao, &aeroporto.portoesDisponiveis, &aeroporto.esperandoPortaoCritico, &aeroporto.esperandoPortaoInternacional)) {
-                    // Tenta pegar PISTA
-                    if (solicitarRecurso(voo, "Pista", &aeroporto.mutexPista, condsPista, &aeroporto.pistasDisponiveis, &aeroporto.esperandoPistaCritico, &aeroporto.esperandoPistaInternacional)) {
-                        break; // Se conseguiu pegar TUDO sai do loop
-                    } else {
-                        // Se não conseguiu pegar PISTA, libera os outros recursos
-                        liberarRecurso(&aeroporto.mutexTorre, condsTorre, &aeroporto.torreDisponivel, &aeroporto.esperandoTorreCritico, &aeroporto.esperandoTorreInternacional);
-                        liberarRecurso(&aeroporto.mutexPortao, condsPortao, &aeroporto.portoesDisponiveis, &aeroporto.esperandoPortaoCritico, &aeroporto.esperandoPortaoInternacional);
-                        if (voo->status == ACIDENTE) return NULL; // verifica se o avião caiu e termina a thread
-                    }
-                } else {
-                    // Se não conseguiu pista, libera o portão que tinha pegado
-                    liberarRecurso(&aeroporto.mutexTorre, condsTorre, &aeroporto.torreDisponivel, &aeroporto.esperandoTorreCritico, &aeroporto.esperandoTorreInternacional);
-                    if (voo->status == ACIDENTE) return NULL; // Se caiu retorna NULL
-                }
+        }
+        if (saiNoTexto(&celula->registro)) {
+            usado += formatarRegistro(&celula->registro, saida + usado, sizeof(saida) - usado);
+            if (++linhas % LOTE_LOG == 0) {
+                fwrite(saida, 1, usado, stdout);
+                usado = 0;
             }
         }
-        if(voo->status == ACIDENTE) return NULL; // Após as tentativas verifica se caiu
-        sleep(rand() % 3 + 1); // Espera aleatoriamente entre as tentativas 
+        // Libera a celula para a proxima volta do buffer
+        atomic_store_explicit(&celula->sequencia, bufferDeLog.posicaoLeitura + bufferDeLog.mascara + 1, memory_order_release);
+        bufferDeLog.posicaoLeitura++;
+        lidos++;
+    }
+    if (noLote > 0) escreverNoRastro(lote, noLote * sizeof(RegistroLog));
+    if (bufferDeLog.rastro >= 0) bufferDeLog.registrosNoRastro += lidos;
+    if (usado > 0) fwrite(saida, 1, usado, stdout);
+    if (linhas > 0) fflush(stdout);
+    return lidos;
+}
+
+static void* executarConsumidorDeLog(void *arg) {
+    (void)arg;
+    struct timespec pausa = { 0, NS_POR_MILISSEGUNDO };
+    while (1) {
+        int encerrando = atomic_load(&bufferDeLog.encerrando);
+        if (esvaziarBufferDeLog() > 0) continue;
+        // So sai depois de uma passada vazia feita apos o pedido de encerramento
+        if (encerrando) break;
+        nanosleep(&pausa, NULL);
+    }
+    return NULL;
+}
+
+void iniciarLog() {
+    bufferDeLog.celulas = malloc(CAPACIDADE_LOG * sizeof(CelulaLog));
+    if (bufferDeLog.celulas == NULL) { perror("malloc"); exit(1); }
+    bufferDeLog.mascara = CAPACIDADE_LOG - 1;
+    for (size_t i = 0; i < CAPACIDADE_LOG; i++) atomic_init(&bufferDeLog.celulas[i].sequencia, i);
+    atomic_init(&bufferDeLog.posicaoEscrita, 0);
+    bufferDeLog.posicaoLeitura = 0;
+    atomic_init(&bufferDeLog.descartados, 0);
+    atomic_init(&bufferDeLog.encerrando, 0);
+    struct timespec agora;
+    clock_gettime(CLOCK_REALTIME, &agora);
+    bufferDeLog.inicioDeParedeNs = (int64_t)agora.tv_sec * NS_POR_SEGUNDO + agora.tv_nsec;
+    bufferDeLog.rastro = -1;
+    bufferDeLog.registrosNoRastro = 0;
+    bufferDeLog.emRede = simulacao->config.numeroDeAeroportos > 1;
+    if (rastreando) {
+        bufferDeLog.rastro = open(caminhoDoRastro, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (bufferDeLog.rastro < 0) { perror(caminhoDoRastro); exit(1); }
+        CabecalhoRastro cabecalho = { { 'R', 'A', 'S', 'T' }, VERSAO_RASTRO, { 0 }, (uint16_t)modoEventos };
+        for (int r = 0; r < NUM_RECURSOS; r++) cabecalho.capacidade[r] = (uint16_t)simulacao->config.capacidade[r];
+        escreverNoRastro(&cabecalho, sizeof(cabecalho));
+    }
+    pthread_create(&bufferDeLog.consumidor, NULL, executarConsumidorDeLog, NULL);
+}
+
+void finalizarLog() {
+    atomic_store(&bufferDeLog.encerrando, 1);
+    pthread_join(bufferDeLog.consumidor, NULL);
+    free(bufferDeLog.celulas);
+    if (bufferDeLog.rastro >= 0) close(bufferDeLog.rastro);
+}
+
+// ---========= PAINEL EM MEMORIA COMPARTILHADA =========---
+// Uma thread separada monta o retrato a cada INTERVALO_PAINEL_MS e o publica com o seqlock de
+// painel.h. Ela nao trava nenhum mutex da simulacao: le com LER_RELAXADO os contadores _Atomic
+// das fatias e a copia da ocupacao que cada recurso grava ao destravar o mutex. O retrato pode
+// misturar instantes um pouco diferentes entre recursos, mas o monitor nunca atrasa um voo.
+
+static struct {
+    PainelCompartilhado *compartilhado;
+    PainelCompartilhado retrato;  // Montado aqui e copiado para a memoria compartilhada de uma vez
+    Simulacao *simulacao;
+    pthread_t publicador;
+    atomic_int encerrando;
+} painel;
+
+static void publicarRetrato(int encerrada) {
+    Simulacao *sim = painel.simulacao;
+    PainelCompartilhado *retrato = &painel.retrato;
+    if (modoEventos) {
+        retrato->instanteNs = LER_RELAXADO(sim->relogioVirtualNs);
+    } else {
+        struct timespec agora;
+        clock_gettime(CLOCK_MONOTONIC, &agora);
+        retrato->instanteNs = (int64_t)agora.tv_sec * NS_POR_SEGUNDO + agora.tv_nsec - LER_RELAXADO(sim->inicioRealNs);
+    }
+    memset(retrato->disponivel, 0, sizeof(retrato->disponivel));
+    memset(retrato->esperando, 0, sizeof(retrato->esperando));
+    for (int a = 0; a < sim->config.numeroDeAeroportos; a++) {
+        for (int r = 0; r < NUM_RECURSOS; r++) {
+            PoolDeRecurso *recurso = &sim->aeroportos[a].recursos[r];
+            retrato->disponivel[r] += LER_RELAXADO(recurso->disponivelPublicado);
+            for (int c = 0; c < NUM_CLASSES; c++) retrato->esperando[r][c] += LER_RELAXADO(recurso->esperandoPublicado[c]);
+        }
     }
+    memset(retrato->voosPorSituacao, 0, sizeof(retrato->voosPorSituacao));
+    retrato->voosSucesso = retrato->voosAcidentados = retrato->alertasDeStarvation = retrato->deadlocksEvitados = 0;
+    retrato->concessoes = retrato->despertares = retrato->esperasConcluidas = retrato->somaEsperaNs = 0;
+    for (int i = 0; i < sim->numeroDeWorkers; i++) {
+        Estatisticas *fatia = &sim->fatias[i].contadores;
+        for (int s = 0; s < NUM_SITUACOES; s++) retrato->voosPorSituacao[s] += LER_RELAXADO(fatia->voosPorSituacao[s]);
+        retrato->voosSucesso += LER_RELAXADO(fatia->voosSucesso);
+        retrato->voosAcidentados += LER_RELAXADO(fatia->voosAcidentados);
+        retrato->alertasDeStarvation += LER_RELAXADO(fatia->alertasDeStarvation);
+        retrato->deadlocksEvitados += LER_RELAXADO(fatia->deadlocksEvitados);
+        retrato->concessoes += LER_RELAXADO(fatia->concessoes);
+        retrato->despertares += LER_RELAXADO(fatia->despertares);
+        retrato->esperasConcluidas += LER_RELAXADO(fatia->esperasConcluidas);
+        retrato->somaEsperaNs += LER_RELAXADO(fatia->somaEsperaNs);
+    }
+    retrato->voosCriados = LER_RELAXADO(sim->totalDeVoosCriados);
+    retrato->encerrada = encerrada;
+    retrato->publicacoes++;
 
-    sleep((TEMPO_BASE_OPERACAO * 1) + (TEMPO_BASE_OPERACAO * 0.1) + (TEMPO_BASE_OPERACAO * 0.5)); // Precisa dos tres
-    logEvento(voo->id, voo->tipo, "decolagem concluida. Liberando todos os recursos.");
-    liberarRecurso(&aeroporto.mutexPortao, condsPortao, &aeroporto.portoesDisponiveis, &aeroporto.esperandoPortaoCritico, &aeroporto.esperandoPortaoInternacional);
-    liberarRecurso(&aeroporto.mutexPista, condsPista, &aeroporto.pistasDisponiveis, &aeroporto.esperandoPistaCritico, &aeroporto.esperandoPistaInternacional);
-    liberarRecurso(&aeroporto.mutexTorre, condsTorre, &aeroporto.torreDisponivel, &aeroporto.esperandoTorreCritico, &aeroporto.esperandoTorreInternacional);
+    // Seqlock: impar enquanto copia, par de novo no fim
+    PainelCompartilhado *destino = painel.compartilhado;
+    unsigned int sequencia = atomic_load_explicit(&destino->sequencia, memory_order_relaxed);
+    atomic_store_explicit(&destino->sequencia, sequencia + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    size_t inicio = offsetof(PainelCompartilhado, versao);
+    memcpy((char*)destino + inicio, (char*)retrato + inicio, sizeof(PainelCompartilhado) - inicio);
+    atomic_store_explicit(&destino->sequencia, sequencia + 2, memory_order_release);
+}
 
-    voo->status = CONCLUIDO; // Define o status do voo para CONCLUIDO
-    pthread_mutex_lock(&estatisticas.mutexEstatisticas); 
-    estatisticas.voosSucesso++; 
-    pthread_mutex_unlock(&estatisticas.mutexEstatisticas);
+static void* executarPublicador(void *arg) {
+    simulacao = arg;
+    struct timespec pausa = { 0, INTERVALO_PAINEL_MS * NS_POR_MILISSEGUNDO };
+    while (!atomic_load(&painel.encerrando)) {
+        nanosleep(&pausa, NULL);
+        publicarRetrato(0);
+    }
     return NULL;
 }
 
-int solicitarRecurso(InfoVoo *voo, const char* nomeRecurso, pthread_mutex_t *mutex, pthread_cond_t *conds[3], int *recursoDisponivel, int *esperandoCritico, int *esperandoInternacional) {
-    pthread_mutex_lock(mutex); // Garante acesso exclusivo à variável que representa o recurso.
-    time_t inicio_desta_tentativa = time(NULL); // Marca o inicio dessa tentativa
-
-    // Fica esperando se:
-    // 1. Não tem recursos disponives
-    // 2. Não é critico e não tem críticos esperando
-    // 3. Doméstico, não crítico e internacionais na fila
-    while (*recursoDisponivel == 0 ||
-           (!voo->eCritico && *esperandoCritico > 0) ||
-           (voo->tipo == DOMESTICO && !voo->eCritico && *esperandoInternacional > 0))
-    {
-        // Define a fila de espera:
-        // conds[0] -> Críticos; [1] -> Internacionais; [2] -> Domesticos
-        pthread_cond_t *fila_de_espera = voo->eCritico ? conds[0] : (voo->tipo == INTERNACIONAL ? conds[1] : conds[2]);
-        // Marca se o avião está na fila internacional
-        if (voo->tipo == INTERNACIONAL && !voo->eCritico) (*esperandoInternacional)++;
-
-        // Espera um segundo antes de verificar sua situação
-        struct timespec timeout;
-        clock_gettime(CLOCK_REALTIME, &timeout);
-        timeout.tv_sec += 1;
-        // Função usada para não ficar travado indefinidamente
-        int rc = pthread_cond_timedwait(fila_de_espera, mutex, &timeout);
-        // tira da fila internacional
-        if (voo->tipo == INTERNACIONAL && !voo->eCritico) (*esperandoInternacional)--;
-
-        if (rc == ETIMEDOUT) {
-            // Calcula tempo total de espera
-            time_t tempo_total_espera = time(NULL) - voo->inicioDaEspera;
-            
-            // Se passou do tempo de queda, então caiu
-            if (tempo_total_espera >= QUEDA_AVIAO_SEGUNDOS) {
-                voo->status = ACIDENTE;
-                // Trava o mutex para somar o acidente e libera depois
-                pthread_mutex_lock(&estatisticas.mutexEstatisticas); 
-                estatisticas.voosAcidentados++; 
-                pthread_mutex_unlock(&estatisticas.mutexEstatisticas);
-                logEvento(voo->id, voo->tipo, "CAIU! Tempo de espera excedeu o limite.");
-                // Tira o avião da fila de criticos
-                if (voo->eCritico) (*esperandoCritico)--;
-                pthread_mutex_unlock(mutex);
-                return 0;
-            }
-            // Se esperou demais, vai para crítico
-            if (tempo_total_espera >= ALERTA_FOME_SEGUNDOS && !voo->eCritico) {
-                logEvento(voo->id, voo->tipo, "MAYDAY! MAYDAY! Risco de fome!");
-                voo->eCritico = 1;
-                (*esperandoCritico)++;
-                pthread_mutex_lock(&estatisticas.mutexEstatisticas);
-                estatisticas.alertasDeStarvation++; 
-                pthread_mutex_unlock(&estatisticas.mutexEstatisticas);
-            }
-            // Se passou do tempo limite da tentativa retorna 0
-            if (time(NULL) - inicio_desta_tentativa >= TIMEOUT_TENTATIVA_SEGUNDOS) {
-                pthread_mutex_unlock(mutex);
-                return 0;
+void iniciarPainel() {
+    int fd = shm_open(nomeDoPainel, O_CREAT | O_RDWR | O_TRUNC, 0644);
+    if (fd < 0) { perror(nomeDoPainel); exit(1); }
+    if (ftruncate(fd, sizeof(PainelCompartilhado)) < 0) { perror("ftruncate"); exit(1); }
+    void *mapa = mmap(NULL, sizeof(PainelCompartilhado), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapa == MAP_FAILED) { perror("mmap"); exit(1); }
+    close(fd);
+    painel.compartilhado = mapa;
+    painel.simulacao = simulacao;
+    memset(&painel.retrato, 0, sizeof(painel.retrato));
+    painel.retrato.versao = VERSAO_PAINEL;
+    painel.retrato.pid = getpid();
+    painel.retrato.modoEventos = modoEventos;
+    // Na rede, capacidade e disponibilidade sao a soma dos aeroportos. Os workers ainda nao rodam,
+    // entao a copia da ocupacao comeca direto dos recursos (um instantaneo restaurado ja tem filas).
+    int aeroportos = simulacao->config.numeroDeAeroportos;
+    for (int r = 0; r < NUM_RECURSOS; r++) {
+        painel.retrato.capacidade[r] = simulacao->config.capacidade[r] * aeroportos;
+        for (int a = 0; a < aeroportos; a++) publicarOcupacao(&simulacao->aeroportos[a], r);
+    }
+    publicarRetrato(0);
+    atomic_init(&painel.encerrando, 0);
+    pthread_create(&painel.publicador, NULL, executarPublicador, simulacao);
+}
+
+// Publica o retrato final (encerrada = 1) e remove o nome; quem ja mapeou continua lendo
+void finalizarPainel() {
+    atomic_store(&painel.encerrando, 1);
+    pthread_join(painel.publicador, NULL);
+    publicarRetrato(1);
+    munmap(painel.compartilhado, sizeof(PainelCompartilhado));
+    shm_unlink(nomeDoPainel);
+}
+
+// ---========= INSTANTANEOS (CHECKPOINT E RESTAURACAO) =========---
+// So no modo de eventos, onde entre dois eventos (ou entre janelas, na rede) nada esta pela metade.
+// Nesse ponto a simulacao faz fork(): o filho recebe uma copia do estado por copy-on-write, troca
+// os ponteiros para InfoVoo por indices na reserva de voos e grava tudo, enquanto o pai segue logo
+// depois do fork. O pai tem outras threads (log, painel, workers da rede parados na barreira), que
+// no filho nao existem: um lock do malloc ou do stdio que alguma segurava no fork ficaria travado
+// para sempre. Entao o que precisa de memoria (arquivo aberto, lotes ordenados) e preparado pelo
+// pai, e o filho so le a copia do estado e chama write(), close(), rename() e _exit().
+// O arquivo so serve para o mesmo binario (tamanhos das estruturas no cabecalho).
+// Formato: cabecalho, caminho do arquivo de chegadas, Estatisticas somadas, recursos de cada
+// aeroporto, agendas (chegadas e uma por aeroporto), lotes de InfoVoo e o resumo de cada voo criado.
+
+#define VERSAO_INSTANTANEO 1
+typedef struct {
+    char assinatura[4];             // "INST"
+    uint32_t versao;
+    uint32_t tamanhoDoVoo, tamanhoDoEvento, tamanhoDasEstatisticas;
+    uint32_t tamanhoDoCaminho;      // Caminho do arquivo de chegadas, logo depois do cabecalho
+    Configuracao config;            // config.arquivoDeChegadas nao vale nada no arquivo
+    int32_t totalDeVoosCriados, numeroDeLotes, voosEmAndamento, chegadasEncerradas, haProximaChegada;
+    int64_t relogioVirtualNs;
+    long janelas;
+    GeradorAleatorio geradorDeChegadas;
+    RegistroDeChegada proximaChegada;
+    size_t posicaoNasChegadas, descartadoAte;
+    long linhasIgnoradas;
+    int64_t ultimaChegadaLidaNs;
+    uintptr_t livres;               // Primeiro InfoVoo livre da reserva (indice)
+} CabecalhoInstantaneo;
+
+// Estado que a agenda leva para o arquivo, seguido pelos eventos
+typedef struct {
+    uint64_t tamanho, proximaSequencia;
+} CabecalhoAgenda;
+
+// Recursos de um aeroporto como ficam no arquivo (sem os mutexes)
+typedef struct {
+    int capacidade[NUM_RECURSOS], disponivel[NUM_RECURSOS];
+    int esperandoCritico[NUM_RECURSOS], esperandoInternacional[NUM_RECURSOS];
+    FilaVoos filas[NUM_RECURSOS][3];
+    FilaVoos pendentes;
+    int esperandoNoEscalonador[NUM_RECURSOS][3];
+    int64_t relogioNs;
+} RecursosNoInstantaneo;
+
+// Instantaneo aberto com -c: mapeado uma vez, cada simulacao restaurada copia dele
+static struct {
+    const char *dados;
+    size_t tamanho;
+    const CabecalhoInstantaneo *cabecalho;
+} instantaneo;
+
+// Lotes ordenados por endereco, para achar o lote de um ponteiro. O pai ordena antes do fork e o
+// processo filho usa.
+typedef struct {
+    const InfoVoo *inicio;
+    int lote;
+} LotePorEndereco;
+static LotePorEndereco *lotesPorEndereco;
+static int lotesOrdenados;           // Capacidade de lotesPorEndereco
+static char caminhoTemporario[4096]; // Onde o filho grava antes de renomear
+
+static int compararLotes(const void *a, const void *b) {
+    const InfoVoo *x = ((const LotePorEndereco*)a)->inicio, *y = ((const LotePorEndereco*)b)->inicio;
+    return x < y ? -1 : x > y;
+}
+
+// 0 para NULL (ou lixo de um InfoVoo nunca usado); senao 1 + lote * VOOS_POR_LOTE + posicao
+static uintptr_t indiceDoVoo(const InfoVoo *voo) {
+    ReservaDeVoos *reserva = &simulacao->reservaDeVoos;
+    int inicio = 0, fim = reserva->numeroDeLotes - 1;
+    while (voo != NULL && inicio <= fim) {
+        int meio = (inicio + fim) / 2;
+        const InfoVoo *lote = lotesPorEndereco[meio].inicio;
+        if (voo < lote) fim = meio - 1;
+        else if (voo >= lote + VOOS_POR_LOTE) inicio = meio + 1;
+        else return 1 + (uintptr_t)lotesPorEndereco[meio].lote * VOOS_POR_LOTE + (uintptr_t)(voo - lote);
+    }
+    return 0;
+}
+
+static InfoVoo* vooDoIndice(const void *indice) {
+    uintptr_t i = (uintptr_t)indice;
+    if (i == 0) return NULL;
+    return &simulacao->reservaDeVoos.lotes[(i - 1) / VOOS_POR_LOTE][(i - 1) % VOOS_POR_LOTE];
+}
+
+#define PARA_INDICE(campo) ((campo) = (void*)indiceDoVoo(campo))
+#define PARA_PONTEIRO(campo) ((campo) = vooDoIndice(campo))
+
+static int gravarAgenda(int arquivo, FilaDeEventos *agenda) {
+    CabecalhoAgenda cabecalho = { agenda->tamanho, agenda->proximaSequencia };
+    for (size_t i = 0; i < agenda->tamanho; i++) PARA_INDICE(agenda->eventos[i].voo);
+    return escreverTudo(arquivo, &cabecalho, sizeof(cabecalho)) | escreverTudo(arquivo, agenda->eventos, agenda->tamanho * sizeof(Evento));
+}
+
+// Roda no processo filho, dono de uma copia do estado: pode estragar os ponteiros a vontade, mas
+// nao pode alocar memoria nem usar o stdio
+static int gravarNoFilho(int arquivo) {
+    ReservaDeVoos *reserva = &simulacao->reservaDeVoos;
+    int erro = 0;
+    agregarEstatisticas();
+    const char *chegadas = simulacao->config.arquivoDeChegadas;
+    CabecalhoInstantaneo cabecalho = {
+        { 'I', 'N', 'S', 'T' }, VERSAO_INSTANTANEO, sizeof(InfoVoo), sizeof(Evento), sizeof(Estatisticas),
+        chegadas ? strlen(chegadas) : 0, simulacao->config,
+        simulacao->totalDeVoosCriados, reserva->numeroDeLotes, atomic_load(&simulacao->voosEmAndamento),
+        atomic_load(&simulacao->chegadasEncerradas), simulacao->haProximaChegada,
+        simulacao->relogioVirtualNs, simulacao->janelas, simulacao->geradorDeChegadas, simulacao->proximaChegada,
+        simulacao->chegadas.posicao, simulacao->chegadas.descartadoAte, simulacao->chegadas.linhasIgnoradas,
+        simulacao->chegadas.ultimoInstanteNs, indiceDoVoo(reserva->livres)
+    };
+    cabecalho.config.arquivoDeChegadas = NULL;
+    erro |= escreverTudo(arquivo, &cabecalho, sizeof(cabecalho));
+    if (chegadas != NULL) erro |= escreverTudo(arquivo, chegadas, cabecalho.tamanhoDoCaminho);
+    erro |= escreverTudo(arquivo, &simulacao->estatisticas, sizeof(Estatisticas));
+    for (int a = 0; a < simulacao->config.numeroDeAeroportos; a++) {
+        Aeroporto *aeroporto = &simulacao->aeroportos[a];
+        RecursosNoInstantaneo recursos = { .pendentes = aeroporto->pendentes, .relogioNs = aeroporto->relogioNs };
+        PARA_INDICE(recursos.pendentes.inicio);
+        PARA_INDICE(recursos.pendentes.fim);
+        memcpy(recursos.esperandoNoEscalonador, aeroporto->esperandoNoEscalonador, sizeof(recursos.esperandoNoEscalonador));
+        for (int r = 0; r < NUM_RECURSOS; r++) {
+            PoolDeRecurso *pool = &aeroporto->recursos[r];
+            recursos.capacidade[r] = pool->capacidade;
+            recursos.disponivel[r] = pool->disponivel - pool->deficit; // Negativo se ainda ha deficit
+            recursos.esperandoCritico[r] = pool->esperandoCritico;
+            recursos.esperandoInternacional[r] = pool->esperandoInternacional;
+            for (int c = 0; c < 3; c++) {
+                recursos.filas[r][c] = pool->filas[c];
+                PARA_INDICE(recursos.filas[r][c].inicio);
+                PARA_INDICE(recursos.filas[r][c].fim);
             }
         }
+        erro |= escreverTudo(arquivo, &recursos, sizeof(recursos));
     }
-    // Se conseguiu o recurso
-    // caso seja crítico reseta status e marca ocupado o recurso
-    (*recursoDisponivel)--;
-    if (voo->eCritico) { voo->eCritico = 0; (*esperandoCritico)--; }
-    pthread_mutex_unlock(mutex); // libera o mutex e retorna 1
-    return 1;
+    erro |= gravarAgenda(arquivo, &simulacao->agendas[0]);
+    for (int a = 0; a < simulacao->config.numeroDeAeroportos; a++) erro |= gravarAgenda(arquivo, &simulacao->aeroportos[a].agenda);
+    // Os ponteiros dos InfoVoo so mudam depois de todos os outros terem sido convertidos
+    for (int k = 0; k < reserva->numeroDeLotes; k++) {
+        for (int i = 0; i < VOOS_POR_LOTE; i++) {
+            InfoVoo *voo = &reserva->lotes[k][i];
+            PARA_INDICE(voo->proximoNaFila);
+            PARA_INDICE(voo->anteriorNaFila);
+        }
+    }
+    for (int k = 0; k < reserva->numeroDeLotes; k++) erro |= escreverTudo(arquivo, reserva->lotes[k], VOOS_POR_LOTE * sizeof(InfoVoo));
+    for (int k = 0, resta = simulacao->totalDeVoosCriados; resta > 0; k++) {
+        int noBloco = (VOOS_POR_BLOCO << k) < resta ? (VOOS_POR_BLOCO << k) : resta;
+        BlocoDeVoos *bloco = &simulacao->blocosDeVoos[k];
+        erro |= escreverTudo(arquivo, bloco->codigos, noBloco * sizeof(int32_t));
+        erro |= escreverTudo(arquivo, bloco->tipos, noBloco);
+        erro |= escreverTudo(arquivo, bloco->situacoes, noBloco);
+        resta -= noBloco;
+    }
+    return erro | close(arquivo);
 }
 
-void liberarRecurso(pthread_mutex_t *mutex, pthread_cond_t *conds[3], int *recursoDisponivel, int *esperandoCritico, int *esperandoInternacional) {
-    pthread_mutex_lock(mutex); // Travao mutex
-    (*recursoDisponivel)++; // Aumenta o contador de recursos disponives
-    // Escolhe quem avisar primeiro:
-    // 1. Criticos; 2. Internacionais; 3. Domesticos
-    if (*esperandoCritico > 0) pthread_cond_broadcast(conds[0]);
-    else if (*esperandoInternacional > 0) pthread_cond_broadcast(conds[1]);
-    else pthread_cond_broadcast(conds[2]);
-    // Libera o mutex
-    pthread_mutex_unlock(mutex);
+// Chamado entre eventos: grava se o relogio passou do proximo instantaneo e o anterior ja terminou
+void gravarInstantaneoSeVenceu() {
+    if (caminhoDoInstantaneo == NULL || simulacao->relogioVirtualNs < simulacao->proximoInstantaneoNs) return;
+    while (simulacao->proximoInstantaneoNs <= simulacao->relogioVirtualNs) simulacao->proximoInstantaneoNs += intervaloDoInstantaneoNs;
+    if (simulacao->gravadorDoInstantaneo > 0) {
+        if (waitpid(simulacao->gravadorDoInstantaneo, NULL, WNOHANG) == 0) return; // Ainda gravando o anterior
+        simulacao->gravadorDoInstantaneo = 0;
+    }
+    // Na rede, os voos em transito vao para as agendas antes (prepararJanela faria o mesmo em seguida)
+    for (int a = 0; a < simulacao->config.numeroDeAeroportos; a++) receberVoosEmTransito(&simulacao->aeroportos[a]);
+    int64_t antes = relogioRealNs();
+    ReservaDeVoos *reserva = &simulacao->reservaDeVoos;
+    if (lotesOrdenados < reserva->numeroDeLotes) {
+        lotesOrdenados = reserva->numeroDeLotes * 2;
+        lotesPorEndereco = realloc(lotesPorEndereco, lotesOrdenados * sizeof(LotePorEndereco));
+        if (lotesPorEndereco == NULL) { perror("realloc"); exit(1); }
+    }
+    for (int k = 0; k < reserva->numeroDeLotes; k++) lotesPorEndereco[k] = (LotePorEndereco){ reserva->lotes[k], k };
+    qsort(lotesPorEndereco, reserva->numeroDeLotes, sizeof(LotePorEndereco), compararLotes);
+    // Grava ao lado e renomeia: quem le nunca ve um instantaneo pela metade
+    snprintf(caminhoTemporario, sizeof(caminhoTemporario), "%s.tmp", caminhoDoInstantaneo);
+    int arquivo = open(caminhoTemporario, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (arquivo < 0) { perror(caminhoTemporario); return; }
+    pid_t filho = fork();
+    if (filho == 0) _exit(gravarNoFilho(arquivo) == 0 && rename(caminhoTemporario, caminhoDoInstantaneo) == 0 ? 0 : 1);
+    close(arquivo);
+    if (filho < 0) { perror("fork"); return; }
+    simulacao->gravadorDoInstantaneo = filho;
+    simulacao->instantaneosGravados++;
+    simulacao->pausaDosInstantaneosNs += relogioRealNs() - antes;
 }
 
-void inicializarAeroporto() {
-    // Define numero de recursos
-    aeroporto.pistasDisponiveis = NUMERO_PISTAS;
-    aeroporto.portoesDisponiveis = NUMERO_PORTOES;
-    aeroporto.torreDisponivel = CAPACIDADE_TORRE;
-    // Inicializa as filas com 0
-    aeroporto.esperandoPistaCritico = 0; 
-    aeroporto.esperandoPistaInternacional = 0;
-    aeroporto.esperandoPortaoCritico = 0; 
-    aeroporto.esperandoPortaoInternacional = 0;
-    aeroporto.esperandoTorreCritico = 0; 
-    aeroporto.esperandoTorreInternacional = 0;
-    // Cria mutexes para todos os recursos
-    pthread_mutex_init(&aeroporto.mutexPista, NULL);
-    pthread_mutex_init(&aeroporto.mutexPortao, NULL);
-    pthread_mutex_init(&aeroporto.mutexTorre, NULL);
-    pthread_mutex_init(&estatisticas.mutexEstatisticas, NULL);
-    // Variaveis de condição para prioridades e recursos
-    pthread_cond_init(&aeroporto.condPistaCritico, NULL); 
-    pthread_cond_init(&aeroporto.condPistaInternacional, NULL); 
-    pthread_cond_init(&aeroporto.condPistaDomestico, NULL);
-    pthread_cond_init(&aeroporto.condPortaoCritico, NULL); 
-    pthread_cond_init(&aeroporto.condPortaoInternacional, NULL); 
-    pthread_cond_init(&aeroporto.condPortaoDomestico, NULL);
-    pthread_cond_init(&aeroporto.condTorreCritico, NULL); 
-    pthread_cond_init(&aeroporto.condTorreInternacional, NULL); 
-    pthread_cond_init(&aeroporto.condTorreDomestico, NULL);
-    // Define todas as estatisticas como 0
-    estatisticas.voosSucesso = 0; 
-    estatisticas.voosAcidentados = 0;
-    estatisticas.deadlocksEvitados = 0; 
-    estatisticas.alertasDeStarvation = 0;
+// Espera o ultimo filho terminar de gravar
+void esperarGravacaoDoInstantaneo() {
+    int situacao;
+    free(lotesPorEndereco);
+    lotesPorEndereco = NULL;
+    lotesOrdenados = 0;
+    if (simulacao->gravadorDoInstantaneo <= 0) return;
+    if (waitpid(simulacao->gravadorDoInstantaneo, &situacao, 0) > 0 && (!WIFEXITED(situacao) || WEXITSTATUS(situacao) != 0)) {
+        fprintf(stderr, "Falha ao gravar o instantaneo %s\n", caminhoDoInstantaneo);
+    }
+    simulacao->gravadorDoInstantaneo = 0;
 }
 
-void destruirAeroporto() {
-    // Libera todos os mutexes criados
-    pthread_mutex_destroy(&aeroporto.mutexPista); 
-    pthread_mutex_destroy(&aeroporto.mutexPortao); 
-    pthread_mutex_destroy(&aeroporto.mutexTorre);
-    pthread_mutex_destroy(&estatisticas.mutexEstatisticas);
-    // Libera as variaves de condição
-    pthread_cond_destroy(&aeroporto.condPistaCritico); 
-    pthread_cond_destroy(&aeroporto.condPistaInternacional);
-    pthread_cond_destroy(&aeroporto.condPistaDomestico);
-    pthread_cond_destroy(&aeroporto.condPortaoCritico); 
-    pthread_cond_destroy(&aeroporto.condPortaoInternacional); 
-    pthread_cond_destroy(&aeroporto.condPortaoDomestico);
-    pthread_cond_destroy(&aeroporto.condTorreCritico); 
-    pthread_cond_destroy(&aeroporto.condTorreInternacional); 
-    pthread_cond_destroy(&aeroporto.condTorreDomestico);
-}
-
-void logEvento(int id, TipoVoo tipo, const char* mensagem) {
-    time_t agora = time(NULL); struct tm * ptm = localtime(&agora);
-    char buf[30]; strftime(buf, 30, "%H:%M:%S", ptm);
-    printf("[%s] Voo %03d (%s): %s\n", buf, id, tipo == INTERNACIONAL ? "Internacional" : "Domestico   ", mensagem);
-    fflush(stdout);
+// Mapeia o instantaneo, confere se e deste binario e devolve a configuracao gravada
+void abrirInstantaneo(const char *caminho, Configuracao *config) {
+    int fd = open(caminho, O_RDONLY);
+    if (fd < 0) { perror(caminho); exit(1); }
+    struct stat info;
+    if (fstat(fd, &info) < 0) { perror("fstat"); exit(1); }
+    instantaneo.tamanho = info.st_size;
+    void *dados = instantaneo.tamanho >= sizeof(CabecalhoInstantaneo) ?
+        mmap(NULL, instantaneo.tamanho, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    close(fd);
+    const CabecalhoInstantaneo *cabecalho = dados;
+    if (dados == MAP_FAILED || memcmp(cabecalho->assinatura, "INST", 4) != 0 || cabecalho->versao != VERSAO_INSTANTANEO ||
+        cabecalho->tamanhoDoVoo != sizeof(InfoVoo) || cabecalho->tamanhoDoEvento != sizeof(Evento) ||
+        cabecalho->tamanhoDasEstatisticas != sizeof(Estatisticas)) {
+        fprintf(stderr, "%s: nao e um instantaneo gravado por este binario\n", caminho);
+        exit(1);
+    }
+    instantaneo.dados = dados;
+    instantaneo.cabecalho = cabecalho;
+    *config = cabecalho->config;
+    if (cabecalho->tamanhoDoCaminho > 0) config->arquivoDeChegadas = strndup(instantaneo.dados + sizeof(*cabecalho), cabecalho->tamanhoDoCaminho);
+}
+
+static const void* lerDoInstantaneo(size_t *posicao, size_t tamanho) {
+    if (*posicao + tamanho > instantaneo.tamanho) {
+        fprintf(stderr, "Instantaneo truncado\n");
+        exit(1);
+    }
+    const void *dados = instantaneo.dados + *posicao;
+    *posicao += tamanho;
+    return dados;
+}
+
+static void restaurarAgenda(size_t *posicao, FilaDeEventos *agenda) {
+    const CabecalhoAgenda *cabecalho = lerDoInstantaneo(posicao, sizeof(CabecalhoAgenda));
+    agenda->tamanho = agenda->capacidade = cabecalho->tamanho;
+    agenda->proximaSequencia = cabecalho->proximaSequencia;
+    agenda->eventos = realloc(agenda->eventos, (agenda->capacidade ? agenda->capacidade : 1) * sizeof(Evento));
+    if (agenda->eventos == NULL) { perror("realloc"); exit(1); }
+    memcpy(agenda->eventos, lerDoInstantaneo(posicao, agenda->tamanho * sizeof(Evento)), agenda->tamanho * sizeof(Evento));
+    for (size_t i = 0; i < agenda->tamanho; i++) PARA_PONTEIRO(agenda->eventos[i].voo);
+}
+
+// Reagenda o alerta e a queda dos voos de uma fila (ou da lista do escalonador) a partir do inicio da
+// espera, com os limites novos. Os eventos antigos ficam na agenda, mas nao batem mais com
+// alertaAgendado/quedaAgendada e sao ignorados; o prazo que o limite novo ja venceu dispara em agora.
+static void reagendarPrazos(InfoVoo *voo, int64_t agora, int64_t atrasoDaQueda) {
+    for (; voo != NULL; voo = voo->proximoNaFila) {
+        int64_t fome = prazoDeFome(voo) > agora ? prazoDeFome(voo) : agora;
+        int64_t queda = prazoDeQueda(voo) > agora ? prazoDeQueda(voo) : agora;
+        if (voo->alertaAgendado != fome) {
+            voo->alertaAgendado = fome;
+            agendarEvento(fome, EV_ALERTA_FOME, voo);
+        }
+        if (voo->quedaAgendada != queda) {
+            voo->quedaAgendada = queda;
+            agendarEvento(queda, EV_QUEDA, voo);
+        }
+        voo->prioridade += atrasoDaQueda; // So conta na lista do escalonador
+    }
+}
+
+// Troca o estado da simulacao recem-criada pelo do instantaneo. Da configuracao da simulacao valem as
+// capacidades (as unidades a mais ou a menos entram ou saem das livres, ou das em uso quando nao ha
+// livres que bastem), a semente dos voos novos, a duracao, a fracao internacional e os limites de
+// fome e queda, que valem tambem para quem ja esta esperando (contados do inicio da fase).
+void restaurarInstantaneo() {
+    const CabecalhoInstantaneo *cabecalho = instantaneo.cabecalho;
+    size_t posicao = sizeof(CabecalhoInstantaneo) + cabecalho->tamanhoDoCaminho;
+    ReservaDeVoos *reserva = &simulacao->reservaDeVoos;
+    simulacao->restaurada = 1;
+    simulacao->relogioVirtualNs = cabecalho->relogioVirtualNs;
+    simulacao->janelas = cabecalho->janelas;
+    simulacao->totalDeVoosCriados = cabecalho->totalDeVoosCriados;
+    atomic_store(&simulacao->voosEmAndamento, cabecalho->voosEmAndamento);
+    atomic_store(&simulacao->chegadasEncerradas, cabecalho->chegadasEncerradas);
+    if (simulacao->config.semente == cabecalho->config.semente) simulacao->geradorDeChegadas = cabecalho->geradorDeChegadas;
+    simulacao->haProximaChegada = cabecalho->haProximaChegada;
+    simulacao->proximaChegada = cabecalho->proximaChegada;
+    simulacao->chegadas.posicao = cabecalho->posicaoNasChegadas;
+    simulacao->chegadas.descartadoAte = cabecalho->descartadoAte;
+    simulacao->chegadas.linhasIgnoradas = cabecalho->linhasIgnoradas;
+    simulacao->chegadas.ultimoInstanteNs = cabecalho->ultimaChegadaLidaNs;
+    simulacao->fatias[0].contadores = *(const Estatisticas*)lerDoInstantaneo(&posicao, sizeof(Estatisticas));
+    // Os lotes vem antes dos ponteiros: as filas e agendas apontam para dentro deles
+    size_t inicioDosRecursos = posicao;
+    posicao += simulacao->config.numeroDeAeroportos * sizeof(RecursosNoInstantaneo);
+    reserva->numeroDeLotes = reserva->capacidadeDeLotes = cabecalho->numeroDeLotes;
+    reserva->lotes = malloc((reserva->capacidadeDeLotes ? reserva->capacidadeDeLotes : 1) * sizeof(InfoVoo*));
+    size_t inicioDasAgendas = posicao;
+    for (int a = -1; a < simulacao->config.numeroDeAeroportos; a++) {
+        const CabecalhoAgenda *agenda = lerDoInstantaneo(&posicao, sizeof(CabecalhoAgenda));
+        posicao += agenda->tamanho * sizeof(Evento);
+    }
+    for (int k = 0; k < reserva->numeroDeLotes; k++) {
+        reserva->lotes[k] = malloc(VOOS_POR_LOTE * sizeof(InfoVoo));
+        if (reserva->lotes[k] == NULL) { perror("malloc"); exit(1); }
+        memcpy(reserva->lotes[k], lerDoInstantaneo(&posicao, VOOS_POR_LOTE * sizeof(InfoVoo)), VOOS_POR_LOTE * sizeof(InfoVoo));
+    }
+    for (int k = 0; k < reserva->numeroDeLotes; k++) {
+        for (int i = 0; i < VOOS_POR_LOTE; i++) {
+            PARA_PONTEIRO(reserva->lotes[k][i].proximoNaFila);
+            PARA_PONTEIRO(reserva->lotes[k][i].anteriorNaFila);
+        }
+    }
+    reserva->livres = vooDoIndice((void*)cabecalho->livres);
+    for (int k = 0, resta = simulacao->totalDeVoosCriados; resta > 0; k++) {
+        int noBloco = (VOOS_POR_BLOCO << k) < resta ? (VOOS_POR_BLOCO << k) : resta;
+        alocarResumo(k);
+        BlocoDeVoos *bloco = &simulacao->blocosDeVoos[k];
+        memcpy(bloco->codigos, lerDoInstantaneo(&posicao, noBloco * sizeof(int32_t)), noBloco * sizeof(int32_t));
+        memcpy(bloco->tipos, lerDoInstantaneo(&posicao, noBloco), noBloco);
+        memcpy(bloco->situacoes, lerDoInstantaneo(&posicao, noBloco), noBloco);
+        resta -= noBloco;
+    }
+    for (int a = 0; a < simulacao->config.numeroDeAeroportos; a++) {
+        Aeroporto *aeroporto = &simulacao->aeroportos[a];
+        const RecursosNoInstantaneo *recursos = lerDoInstantaneo(&inicioDosRecursos, sizeof(RecursosNoInstantaneo));
+        aeroporto->relogioNs = recursos->relogioNs;
+        aeroporto->pendentes = recursos->pendentes;
+        PARA_PONTEIRO(aeroporto->pendentes.inicio);
+        PARA_PONTEIRO(aeroporto->pendentes.fim);
+        memcpy(aeroporto->esperandoNoEscalonador, recursos->esperandoNoEscalonador, sizeof(recursos->esperandoNoEscalonador));
+        for (int r = 0; r < NUM_RECURSOS; r++) {
+            PoolDeRecurso *pool = &aeroporto->recursos[r];
+            // Com menos unidades do que as em uso, nenhuma fica livre e as que sobram somem ao ser
+            // devolvidas, antes de qualquer entrega
+            int disponivel = recursos->disponivel[r] + pool->capacidade - recursos->capacidade[r];
+            pool->disponivel = disponivel > 0 ? disponivel : 0;
+            pool->deficit = disponivel < 0 ? -disponivel : 0;
+            pool->esperandoCritico = recursos->esperandoCritico[r];
+            pool->esperandoInternacional = recursos->esperandoInternacional[r];
+            for (int c = 0; c < 3; c++) {
+                pool->filas[c] = recursos->filas[r][c];
+                PARA_PONTEIRO(pool->filas[c].inicio);
+                PARA_PONTEIRO(pool->filas[c].fim);
+            }
+        }
+    }
+    restaurarAgenda(&inicioDasAgendas, &simulacao->agendas[0]);
+    for (int a = 0; a < simulacao->config.numeroDeAeroportos; a++) restaurarAgenda(&inicioDasAgendas, &simulacao->aeroportos[a].agenda);
+    const Configuracao *gravada = &cabecalho->config;
+    if (simulacao->config.alertaFomeSegundos != gravada->alertaFomeSegundos ||
+        simulacao->config.quedaAviaoSegundos != gravada->quedaAviaoSegundos) {
+        int64_t atrasoDaQueda = (int64_t)(simulacao->config.quedaAviaoSegundos - gravada->quedaAviaoSegundos) * NS_POR_SEGUNDO;
+        for (int a = 0; a < simulacao->config.numeroDeAeroportos; a++) {
+            Aeroporto *aeroporto = &simulacao->aeroportos[a];
+            int64_t agora = aeroporto->relogioNs > simulacao->relogioVirtualNs ? aeroporto->relogioNs : simulacao->relogioVirtualNs;
+            reagendarPrazos(aeroporto->pendentes.inicio, agora, atrasoDaQueda);
+            for (int r = 0; r < NUM_RECURSOS; r++) {
+                for (int c = 0; c < 3; c++) reagendarPrazos(aeroporto->recursos[r].filas[c].inicio, agora, atrasoDaQueda);
+            }
+        }
+    }
+    simulacao->proximoInstantaneoNs = simulacao->relogioVirtualNs + intervaloDoInstantaneoNs;
 }
 
 const char* getStatusEmTexto(StatusVoo status) {
@@ -402,25 +3142,108 @@ const char* getStatusEmTexto(StatusVoo status) {
     }
 }
 
+// Uma linha da tabela de latencias: p50/p90/p99/max da espera e do servico
+static void imprimirLatencias(const char *nome, const char *tipo, const HistogramaLatencia *espera,
+                              const HistogramaLatencia *servico) {
+    if (espera->contagem == 0) return;
+    printf("%-12s %-13s %9ld |", nome, tipo, espera->contagem);
+    const HistogramaLatencia *histogramas[2] = { espera, servico };
+    for (int h = 0; h < 2; h++) {
+        const HistogramaLatencia *histograma = histogramas[h];
+        printf(" %7.3f %7.3f %7.3f %8.3f%s", (double)percentilDoHistograma(histograma, 0.5) / NS_POR_SEGUNDO,
+               (double)percentilDoHistograma(histograma, 0.9) / NS_POR_SEGUNDO,
+               (double)percentilDoHistograma(histograma, 0.99) / NS_POR_SEGUNDO, (double)histograma->maximoNs / NS_POR_SEGUNDO,
+               h == 0 ? " |" : "");
+    }
+    printf("\n");
+}
+
 void imprimirRelatorioFinal() {
+    agregarEstatisticas();
     printf("\n\n======================================================\n");
     printf("              RELATORIO FINAL DA SIMULACAO\n");
     printf("======================================================\n");
-    
+
     printf("\n--- METRICAS GERAIS ---\n");
-    printf("Voos concluidos com sucesso: %d\n", estatisticas.voosSucesso);
-    printf("Voos acidentados por starvation: %d\n", estatisticas.voosAcidentados);
-    printf("Alertas (MAYDAY) emitidos: %d\n", estatisticas.alertasDeStarvation);
-    printf("Potenciais Deadlocks Evitados (Backoffs): %d\n", estatisticas.deadlocksEvitados);
-    printf("Pistas disponiveis: %d\n", aeroporto.pistasDisponiveis);
-    printf("Portoes disponiveis: %d\n", aeroporto.portoesDisponiveis);
-    printf("Capacidade da Torre: %d\n", aeroporto.torreDisponivel);
+    printf("Voos concluidos com sucesso: %d\n", simulacao->estatisticas.voosSucesso);
+    printf("Voos acidentados por starvation: %d\n", simulacao->estatisticas.voosAcidentados);
+    printf("Alertas (MAYDAY) emitidos: %d\n", simulacao->estatisticas.alertasDeStarvation);
+    printf("Potenciais Deadlocks Evitados (Backoffs): %d\n", simulacao->estatisticas.deadlocksEvitados);
+    for (int r = 0; r < NUM_RECURSOS; r++) printf("%s: %d\n", tiposDeRecurso[r].noRelatorio, simulacao->config.capacidade[r]);
+    if (simulacao->config.numeroDeAeroportos > 1) {
+        // Pistas, portoes e torre acima sao de cada aeroporto
+        printf("Rede: %d aeroportos, %ld trechos voados entre eles\n", simulacao->config.numeroDeAeroportos,
+               simulacao->estatisticas.trechosVoados);
+        if (modoEventos) printf("Janelas conservadoras: %ld (%d s cada) | Aeroportos roubados por outro worker: %ld\n",
+                                simulacao->janelas, TEMPO_DE_VOO_MINIMO, simulacao->estatisticas.aeroportosRoubados);
+    }
+    static const char *nomesDasPoliticas[] = {
+        [POLITICA_ATOMICA] = "Atomica (recursos da fase juntos)",
+        [POLITICA_INCREMENTAL] = "Incremental (um por vez com backoff)",
+        [POLITICA_PRAZO] = "Escalonador central (menor prazo de queda primeiro)",
+    };
+    printf("Politica de aquisicao: %s\n", nomesDasPoliticas[simulacao->config.politica]);
+    printf("Latencia media de pouso: %.2f s\n", simulacao->estatisticas.pousosConcluidos ?
+           (double)simulacao->estatisticas.somaLatenciaPousoNs / simulacao->estatisticas.pousosConcluidos / NS_POR_SEGUNDO : 0.0);
+    printf("Latencia media de decolagem: %.2f s\n", simulacao->estatisticas.decolagensConcluidas ?
+           (double)simulacao->estatisticas.somaLatenciaDecolagemNs / simulacao->estatisticas.decolagensConcluidas / NS_POR_SEGUNDO : 0.0);
+    printf("Voos concluidos por hora: %.1f\n", simulacao->estatisticas.duracaoTotalNs > 0 ?
+           simulacao->estatisticas.voosSucesso * 3600.0 * NS_POR_SEGUNDO / simulacao->estatisticas.duracaoTotalNs : 0.0);
+    printf("Espera media pelos recursos de uma fase: %.2f s (p99 ate %.1f s)\n", simulacao->estatisticas.esperasConcluidas ?
+           (double)simulacao->estatisticas.somaEsperaNs / simulacao->estatisticas.esperasConcluidas / NS_POR_SEGUNDO : 0.0,
+           (double)percentilDaEspera(&simulacao->estatisticas, 0.99) / NS_POR_SEGUNDO);
+    printf("Pico de voos ativos ao mesmo tempo: %d\n", simulacao->estatisticas.picoDeVoosAtivos);
+    printf("Despertares por concessao de recurso: %.3f (%ld despertares, %ld concessoes)\n",
+           simulacao->estatisticas.concessoes ? (double)simulacao->estatisticas.despertares / simulacao->estatisticas.concessoes : 0.0,
+           simulacao->estatisticas.despertares, simulacao->estatisticas.concessoes);
+    if (politicaLog == LOG_DESCARTAR) printf("Eventos de log descartados (buffer cheio): %lu\n", atomic_load(&bufferDeLog.descartados));
+    if (rastreando) printf("Registros gravados no rastro %s: %lu\n", caminhoDoRastro, bufferDeLog.registrosNoRastro);
+    if (simulacao->chegadas.linhasIgnoradas > 0) printf("Linhas invalidas ignoradas no arquivo de chegadas: %ld\n", simulacao->chegadas.linhasIgnoradas);
+
+    printf("\n--- DISPUTA PELOS MUTEXES DOS RECURSOS ---\n");
+    if (modoEventos && simulacao->config.numeroDeAeroportos > 1) printf("(modo de eventos: cada aeroporto roda numa thread por vez, tempos de espera e posse nao sao medidos)\n");
+    else if (modoEventos) printf("(modo de eventos: uma thread so, tempos de espera e posse nao sao medidos)\n");
+    printf("%-7s %11s %11s %12s %12s %12s %10s\n", "Recurso", "Aquisicoes", "Disputadas",
+           "Espera med.", "Espera max.", "Posse total", "Backoffs");
+    for (int r = 0; r < NUM_RECURSOS; r++) {
+        PerfilRecurso *perfil = &simulacao->estatisticas.perfil[r];
+        printf("%-7s %11ld %11ld %9.2f us %9.2f us %9.3f ms %10ld\n", nomesDosRecursos[r], perfil->aquisicoes,
+               perfil->aquisicoesDisputadas,
+               perfil->aquisicoesDisputadas ? (double)perfil->esperaTotalNs / perfil->aquisicoesDisputadas / 1000.0 : 0.0,
+               perfil->esperaMaximaNs / 1000.0, perfil->posseTotalNs / (double)NS_POR_MILISSEGUNDO,
+               perfil->liberacoesPorBackoff);
+    }
+
+    printf("\n--- LATENCIAS DAS FASES E DOS RECURSOS (s) ---\n");
+    printf("Espera: do pedido dos recursos a concessao. Servico: da concessao a devolucao no fim da fase.\n");
+    printf("Percentis pelo limite do balde do histograma: ate 1/16 acima do valor exato.\n");
+    printf("%-12s %-13s %9s | %7s %7s %7s %8s | %7s %7s %7s %8s\n", "Fase", "Tipo", "Amostras",
+           "Esp p50", "p90", "p99", "max", "Ser p50", "p90", "p99", "max");
+    for (int f = 0; f < NUM_FASES; f++) {
+        for (int t = 0; t < 2; t++) {
+            imprimirLatencias(nomesDasFases[f], t == INTERNACIONAL ? "Internacional" : "Domestico",
+                              &simulacao->estatisticas.esperaDaFase[f][t], &simulacao->estatisticas.servicoDaFase[f][t]);
+        }
+    }
+    for (int r = 0; r < NUM_RECURSOS; r++) {
+        imprimirLatencias(nomesDosRecursos[r], "Todos", &simulacao->estatisticas.esperaPeloRecurso[r],
+                          &simulacao->estatisticas.posseDoRecurso[r]);
+    }
 
+    if (modoSilencioso) {
+        printf("\n======================================================\n");
+        return;
+    }
     printf("\n--- ESTADO FINAL DE CADA VOO ---\n");
-    for (int i = 0; i < totalDeVoosCriados; i++) {
-        InfoVoo *voo = &todosOsVoos[i];
-        const char *tipo_str = voo->tipo == INTERNACIONAL ? "Internacional" : "Domestico   ";
-        printf("Voo %03d (%s) - Status Final: %s\n", voo->id, tipo_str, getStatusEmTexto(voo->status));
+    // So le o resumo de cada bloco, sem passar pelos InfoVoo
+    int id = 1;
+    for (int k = 0; k < MAX_BLOCOS_DE_VOOS && id <= simulacao->totalDeVoosCriados; k++) {
+        BlocoDeVoos *bloco = &simulacao->blocosDeVoos[k];
+        int tamanho = VOOS_POR_BLOCO << k;
+        for (int i = 0; i < tamanho && id <= simulacao->totalDeVoosCriados; i++, id++) {
+            const char *tipo_str = bloco->tipos[i] == INTERNACIONAL ? "Internacional" : "Domestico   ";
+            printf("Voo %03d (%s) - Status Final: %s\n", bloco->codigos[i], tipo_str, getStatusEmTexto(bloco->situacoes[i]));
+        }
     }
     printf("\n======================================================\n");
-}
\ No newline at end of file
+}